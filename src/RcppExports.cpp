@@ -20,6 +20,26 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// dsSetCompression
+void dsSetCompression(bool compression);
+RcppExport SEXP _ganGenerativeData_dsSetCompression(SEXP compressionSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type compression(compressionSEXP);
+    dsSetCompression(compression);
+    return R_NilValue;
+END_RCPP
+}
+// dsSetPageDirectory
+void dsSetPageDirectory(const std::string& pageDirectory);
+RcppExport SEXP _ganGenerativeData_dsSetPageDirectory(SEXP pageDirectorySEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type pageDirectory(pageDirectorySEXP);
+    dsSetPageDirectory(pageDirectory);
+    return R_NilValue;
+END_RCPP
+}
 // dsRead
 bool dsRead(const std::string& fileName);
 RcppExport SEXP _ganGenerativeData_dsRead(SEXP fileNameSEXP) {
@@ -31,6 +51,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// dsCreateWithCsvFile
+void dsCreateWithCsvFile(const std::string& fileName, CharacterVector columnNames, const std::string& separator);
+RcppExport SEXP _ganGenerativeData_dsCreateWithCsvFile(SEXP fileNameSEXP, SEXP columnNamesSEXP, SEXP separatorSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type columnNames(columnNamesSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type separator(separatorSEXP);
+    dsCreateWithCsvFile(fileName, columnNames, separator);
+    return R_NilValue;
+END_RCPP
+}
 // dsCreate
 void dsCreate(const std::vector<std::wstring>& columnTypes, const std::vector<std::wstring>& columnNames);
 RcppExport SEXP _ganGenerativeData_dsCreate(SEXP columnTypesSEXP, SEXP columnNamesSEXP) {
@@ -52,6 +84,29 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// dsAddNumberColumnValues
+void dsAddNumberColumnValues(int columnIndex, NumericVector values);
+RcppExport SEXP _ganGenerativeData_dsAddNumberColumnValues(SEXP columnIndexSEXP, SEXP valuesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type columnIndex(columnIndexSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type values(valuesSEXP);
+    dsAddNumberColumnValues(columnIndex, values);
+    return R_NilValue;
+END_RCPP
+}
+// dsAddStringColumnValues
+void dsAddStringColumnValues(int columnIndex, IntegerVector codes, const std::vector<std::string>& levels);
+RcppExport SEXP _ganGenerativeData_dsAddStringColumnValues(SEXP columnIndexSEXP, SEXP codesSEXP, SEXP levelsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type columnIndex(columnIndexSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type codes(codesSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type levels(levelsSEXP);
+    dsAddStringColumnValues(columnIndex, codes, levels);
+    return R_NilValue;
+END_RCPP
+}
 // dsDeactivateColumns
 void dsDeactivateColumns(const std::vector<int>& columnVector);
 RcppExport SEXP _ganGenerativeData_dsDeactivateColumns(SEXP columnVectorSEXP) {
@@ -124,15 +179,41 @@ BEGIN_RCPP
 END_RCPP
 }
 // dsIntCalculateDensityValues
-void dsIntCalculateDensityValues(int nNearestNeighbors);
-RcppExport SEXP _ganGenerativeData_dsIntCalculateDensityValues(SEXP nNearestNeighborsSEXP) {
+void dsIntCalculateDensityValues(int nNearestNeighbors, bool knnGraph);
+RcppExport SEXP _ganGenerativeData_dsIntCalculateDensityValues(SEXP nNearestNeighborsSEXP, SEXP knnGraphSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< int >::type nNearestNeighbors(nNearestNeighborsSEXP);
-    dsIntCalculateDensityValues(nNearestNeighbors);
+    Rcpp::traits::input_parameter< bool >::type knnGraph(knnGraphSEXP);
+    dsIntCalculateDensityValues(nNearestNeighbors, knnGraph);
     return R_NilValue;
 END_RCPP
 }
+// dsCalculateOutlierScores
+std::vector<float> dsCalculateOutlierScores(int nNearestNeighbors, bool localOutlierFactor);
+RcppExport SEXP _ganGenerativeData_dsCalculateOutlierScores(SEXP nNearestNeighborsSEXP, SEXP localOutlierFactorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type nNearestNeighbors(nNearestNeighborsSEXP);
+    Rcpp::traits::input_parameter< bool >::type localOutlierFactor(localOutlierFactorSEXP);
+    rcpp_result_gen = Rcpp::wrap(dsCalculateOutlierScores(nNearestNeighbors, localOutlierFactor));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dsIntCalculateOutlierScoresForRecords
+std::vector<float> dsIntCalculateOutlierScoresForRecords(NumericMatrix dataRecords, int nNearestNeighbors, bool localOutlierFactor);
+RcppExport SEXP _ganGenerativeData_dsIntCalculateOutlierScoresForRecords(SEXP dataRecordsSEXP, SEXP nNearestNeighborsSEXP, SEXP localOutlierFactorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type dataRecords(dataRecordsSEXP);
+    Rcpp::traits::input_parameter< int >::type nNearestNeighbors(nNearestNeighborsSEXP);
+    Rcpp::traits::input_parameter< bool >::type localOutlierFactor(localOutlierFactorSEXP);
+    rcpp_result_gen = Rcpp::wrap(dsIntCalculateOutlierScoresForRecords(dataRecords, nNearestNeighbors, localOutlierFactor));
+    return rcpp_result_gen;
+END_RCPP
+}
 // dsDensityValueInverseQuantile
 float dsDensityValueInverseQuantile(float densityValue);
 RcppExport SEXP _ganGenerativeData_dsDensityValueInverseQuantile(SEXP densityValueSEXP) {
@@ -144,6 +225,30 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// dsDensityValueQuantiles
+std::vector<float> dsDensityValueQuantiles(const std::vector<float>& percents, bool approximate);
+RcppExport SEXP _ganGenerativeData_dsDensityValueQuantiles(SEXP percentsSEXP, SEXP approximateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::vector<float>& >::type percents(percentsSEXP);
+    Rcpp::traits::input_parameter< bool >::type approximate(approximateSEXP);
+    rcpp_result_gen = Rcpp::wrap(dsDensityValueQuantiles(percents, approximate));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dsDensityValueInverseQuantiles
+std::vector<float> dsDensityValueInverseQuantiles(const std::vector<float>& densityValues, bool approximate);
+RcppExport SEXP _ganGenerativeData_dsDensityValueInverseQuantiles(SEXP densityValuesSEXP, SEXP approximateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::vector<float>& >::type densityValues(densityValuesSEXP);
+    Rcpp::traits::input_parameter< bool >::type approximate(approximateSEXP);
+    rcpp_result_gen = Rcpp::wrap(dsDensityValueInverseQuantiles(densityValues, approximate));
+    return rcpp_result_gen;
+END_RCPP
+}
 // gdReset
 void gdReset();
 RcppExport SEXP _ganGenerativeData_gdReset() {
@@ -276,6 +381,58 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// gdWriteRepresentativeSubset
+std::vector<int> gdWriteRepresentativeSubset(const std::string& fileName, int size);
+RcppExport SEXP _ganGenerativeData_gdWriteRepresentativeSubset(SEXP fileNameSEXP, SEXP sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdWriteRepresentativeSubset(fileName, size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdSetSeed
+void gdSetSeed(int seed);
+RcppExport SEXP _ganGenerativeData_gdSetSeed(SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    gdSetSeed(seed);
+    return R_NilValue;
+END_RCPP
+}
+// gdSetCompression
+void gdSetCompression(bool compression);
+RcppExport SEXP _ganGenerativeData_gdSetCompression(SEXP compressionSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type compression(compressionSEXP);
+    gdSetCompression(compression);
+    return R_NilValue;
+END_RCPP
+}
+// gdSetNumberOfNearestNeighbors
+void gdSetNumberOfNearestNeighbors(int nNearestNeighbors);
+RcppExport SEXP _ganGenerativeData_gdSetNumberOfNearestNeighbors(SEXP nNearestNeighborsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type nNearestNeighbors(nNearestNeighborsSEXP);
+    gdSetNumberOfNearestNeighbors(nNearestNeighbors);
+    return R_NilValue;
+END_RCPP
+}
+// gdSetPageDirectory
+void gdSetPageDirectory(const std::string& pageDirectory);
+RcppExport SEXP _ganGenerativeData_gdSetPageDirectory(SEXP pageDirectorySEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type pageDirectory(pageDirectorySEXP);
+    gdSetPageDirectory(pageDirectory);
+    return R_NilValue;
+END_RCPP
+}
 // gdCreateGenerativeData
 void gdCreateGenerativeData();
 RcppExport SEXP _ganGenerativeData_gdCreateGenerativeData() {
@@ -316,6 +473,49 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// gdDataSourceGetNormalizedDataRandomMatrix
+NumericMatrix gdDataSourceGetNormalizedDataRandomMatrix(NumericMatrix samples);
+RcppExport SEXP _ganGenerativeData_gdDataSourceGetNormalizedDataRandomMatrix(SEXP samplesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type samples(samplesSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdDataSourceGetNormalizedDataRandomMatrix(samples));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdBatchSamplerStart
+void gdBatchSamplerStart(int seed, bool epochs);
+RcppExport SEXP _ganGenerativeData_gdBatchSamplerStart(SEXP seedSEXP, SEXP epochsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< bool >::type epochs(epochsSEXP);
+    gdBatchSamplerStart(seed, epochs);
+    return R_NilValue;
+END_RCPP
+}
+// gdBatchSamplerNext
+List gdBatchSamplerNext(NumericMatrix samples, NumericMatrix noise);
+RcppExport SEXP _ganGenerativeData_gdBatchSamplerNext(SEXP samplesSEXP, SEXP noiseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type noise(noiseSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdBatchSamplerNext(samples, noise));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdBatchSamplerStop
+void gdBatchSamplerStop();
+RcppExport SEXP _ganGenerativeData_gdBatchSamplerStop() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    gdBatchSamplerStop();
+    return R_NilValue;
+END_RCPP
+}
 // gdDataSourceGetNormalizedDataRandomReference
 std::vector<float> gdDataSourceGetNormalizedDataRandomReference(int rowCount);
 RcppExport SEXP _ganGenerativeData_gdDataSourceGetNormalizedDataRandomReference(SEXP rowCountSEXP) {
@@ -371,15 +571,38 @@ BEGIN_RCPP
 END_RCPP
 }
 // gdAddValueRows
-void gdAddValueRows(const std::vector<float>& valueRows);
+void gdAddValueRows(NumericVector valueRows);
 RcppExport SEXP _ganGenerativeData_gdAddValueRows(SEXP valueRowsSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const std::vector<float>& >::type valueRows(valueRowsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type valueRows(valueRowsSEXP);
     gdAddValueRows(valueRows);
     return R_NilValue;
 END_RCPP
 }
+// gdAddValueRowsWithThreshold
+int gdAddValueRowsWithThreshold(NumericMatrix samples, NumericVector probabilities, double threshold);
+RcppExport SEXP _ganGenerativeData_gdAddValueRowsWithThreshold(SEXP samplesSEXP, SEXP probabilitiesSEXP, SEXP thresholdSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type probabilities(probabilitiesSEXP);
+    Rcpp::traits::input_parameter< double >::type threshold(thresholdSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdAddValueRowsWithThreshold(samples, probabilities, threshold));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdGetAcceptCounts
+NumericVector gdGetAcceptCounts();
+RcppExport SEXP _ganGenerativeData_gdGetAcceptCounts() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(gdGetAcceptCounts());
+    return rcpp_result_gen;
+END_RCPP
+}
 // gdGetNumberOfRows
 int gdGetNumberOfRows();
 RcppExport SEXP _ganGenerativeData_gdGetNumberOfRows() {
@@ -465,14 +688,58 @@ BEGIN_RCPP
 END_RCPP
 }
 // gdIntCalculateDensityValues
-void gdIntCalculateDensityValues();
-RcppExport SEXP _ganGenerativeData_gdIntCalculateDensityValues() {
+void gdIntCalculateDensityValues(bool incremental, bool knnGraph);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateDensityValues(SEXP incrementalSEXP, SEXP knnGraphSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type incremental(incrementalSEXP);
+    Rcpp::traits::input_parameter< bool >::type knnGraph(knnGraphSEXP);
+    gdIntCalculateDensityValues(incremental, knnGraph);
+    return R_NilValue;
+END_RCPP
+}
+// gdIntCalculateDensityValuesForNearestNeighbors
+void gdIntCalculateDensityValuesForNearestNeighbors(std::vector<int> nNearestNeighbors);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateDensityValuesForNearestNeighbors(SEXP nNearestNeighborsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<int> >::type nNearestNeighbors(nNearestNeighborsSEXP);
+    gdIntCalculateDensityValuesForNearestNeighbors(nNearestNeighbors);
+    return R_NilValue;
+END_RCPP
+}
+// gdSelectDensityValues
+void gdSelectDensityValues(int nNearestNeighbors);
+RcppExport SEXP _ganGenerativeData_gdSelectDensityValues(SEXP nNearestNeighborsSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
-    gdIntCalculateDensityValues();
+    Rcpp::traits::input_parameter< int >::type nNearestNeighbors(nNearestNeighborsSEXP);
+    gdSelectDensityValues(nNearestNeighbors);
     return R_NilValue;
 END_RCPP
 }
+// gdGetDensityNearestNeighbors
+std::vector<int> gdGetDensityNearestNeighbors();
+RcppExport SEXP _ganGenerativeData_gdGetDensityNearestNeighbors() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(gdGetDensityNearestNeighbors());
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdIntCalculateApproximateDensityValues
+List gdIntCalculateApproximateDensityValues(int sampleSize, int holdoutSize);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateApproximateDensityValues(SEXP sampleSizeSEXP, SEXP holdoutSizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type sampleSize(sampleSizeSEXP);
+    Rcpp::traits::input_parameter< int >::type holdoutSize(holdoutSizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdIntCalculateApproximateDensityValues(sampleSize, holdoutSize));
+    return rcpp_result_gen;
+END_RCPP
+}
 // gdCalculateDensityValue
 float gdCalculateDensityValue(List dataRecord, bool useSearchTree);
 RcppExport SEXP _ganGenerativeData_gdCalculateDensityValue(SEXP dataRecordSEXP, SEXP useSearchTreeSEXP) {
@@ -485,6 +752,65 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// gdIntCalculateDensityValuesForRecords
+std::vector<float> gdIntCalculateDensityValuesForRecords(NumericMatrix dataRecords, bool useSearchTree);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateDensityValuesForRecords(SEXP dataRecordsSEXP, SEXP useSearchTreeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type dataRecords(dataRecordsSEXP);
+    Rcpp::traits::input_parameter< bool >::type useSearchTree(useSearchTreeSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdIntCalculateDensityValuesForRecords(dataRecords, useSearchTree));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdCalculateOutlierScores
+std::vector<float> gdCalculateOutlierScores(bool localOutlierFactor);
+RcppExport SEXP _ganGenerativeData_gdCalculateOutlierScores(SEXP localOutlierFactorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type localOutlierFactor(localOutlierFactorSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdCalculateOutlierScores(localOutlierFactor));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdIntCalculateOutlierScoresForRecords
+std::vector<float> gdIntCalculateOutlierScoresForRecords(NumericMatrix dataRecords, bool localOutlierFactor);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateOutlierScoresForRecords(SEXP dataRecordsSEXP, SEXP localOutlierFactorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type dataRecords(dataRecordsSEXP);
+    Rcpp::traits::input_parameter< bool >::type localOutlierFactor(localOutlierFactorSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdIntCalculateOutlierScoresForRecords(dataRecords, localOutlierFactor));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdIntCalculateClusters
+std::vector<int> gdIntCalculateClusters(float radius, int minPoints, bool hierarchical, int minClusterSize);
+RcppExport SEXP _ganGenerativeData_gdIntCalculateClusters(SEXP radiusSEXP, SEXP minPointsSEXP, SEXP hierarchicalSEXP, SEXP minClusterSizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< float >::type radius(radiusSEXP);
+    Rcpp::traits::input_parameter< int >::type minPoints(minPointsSEXP);
+    Rcpp::traits::input_parameter< bool >::type hierarchical(hierarchicalSEXP);
+    Rcpp::traits::input_parameter< int >::type minClusterSize(minClusterSizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdIntCalculateClusters(radius, minPoints, hierarchical, minClusterSize));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdGetClusterLabels
+std::vector<int> gdGetClusterLabels();
+RcppExport SEXP _ganGenerativeData_gdGetClusterLabels() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(gdGetClusterLabels());
+    return rcpp_result_gen;
+END_RCPP
+}
 // gdDensityValueQuantile
 float gdDensityValueQuantile(float percent);
 RcppExport SEXP _ganGenerativeData_gdDensityValueQuantile(SEXP percentSEXP) {
@@ -507,6 +833,30 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// gdDensityValueQuantiles
+std::vector<float> gdDensityValueQuantiles(const std::vector<float>& percents, bool approximate);
+RcppExport SEXP _ganGenerativeData_gdDensityValueQuantiles(SEXP percentsSEXP, SEXP approximateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::vector<float>& >::type percents(percentsSEXP);
+    Rcpp::traits::input_parameter< bool >::type approximate(approximateSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdDensityValueQuantiles(percents, approximate));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gdDensityValueInverseQuantiles
+std::vector<float> gdDensityValueInverseQuantiles(const std::vector<float>& densityValues, bool approximate);
+RcppExport SEXP _ganGenerativeData_gdDensityValueInverseQuantiles(SEXP densityValuesSEXP, SEXP approximateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::vector<float>& >::type densityValues(densityValuesSEXP);
+    Rcpp::traits::input_parameter< bool >::type approximate(approximateSEXP);
+    rcpp_result_gen = Rcpp::wrap(gdDensityValueInverseQuantiles(densityValues, approximate));
+    return rcpp_result_gen;
+END_RCPP
+}
 // gdBuildFileName
 std::string gdBuildFileName(const std::string& fileName, float niveau);
 RcppExport SEXP _ganGenerativeData_gdBuildFileName(SEXP fileNameSEXP, SEXP niveauSEXP) {
@@ -657,9 +1007,14 @@ END_RCPP
 
 static const R_CallMethodDef CallEntries[] = {
     {"_ganGenerativeData_dsWrite", (DL_FUNC) &_ganGenerativeData_dsWrite, 1},
+    {"_ganGenerativeData_dsSetCompression", (DL_FUNC) &_ganGenerativeData_dsSetCompression, 1},
+    {"_ganGenerativeData_dsSetPageDirectory", (DL_FUNC) &_ganGenerativeData_dsSetPageDirectory, 1},
     {"_ganGenerativeData_dsRead", (DL_FUNC) &_ganGenerativeData_dsRead, 1},
+    {"_ganGenerativeData_dsCreateWithCsvFile", (DL_FUNC) &_ganGenerativeData_dsCreateWithCsvFile, 3},
     {"_ganGenerativeData_dsCreate", (DL_FUNC) &_ganGenerativeData_dsCreate, 2},
     {"_ganGenerativeData_dsAddValueRow", (DL_FUNC) &_ganGenerativeData_dsAddValueRow, 1},
+    {"_ganGenerativeData_dsAddNumberColumnValues", (DL_FUNC) &_ganGenerativeData_dsAddNumberColumnValues, 2},
+    {"_ganGenerativeData_dsAddStringColumnValues", (DL_FUNC) &_ganGenerativeData_dsAddStringColumnValues, 3},
     {"_ganGenerativeData_dsDeactivateColumns", (DL_FUNC) &_ganGenerativeData_dsDeactivateColumns, 1},
     {"_ganGenerativeData_dsActivateColumns", (DL_FUNC) &_ganGenerativeData_dsActivateColumns, 1},
     {"_ganGenerativeData_dsGetActiveColumnNames", (DL_FUNC) &_ganGenerativeData_dsGetActiveColumnNames, 0},
@@ -667,8 +1022,12 @@ static const R_CallMethodDef CallEntries[] = {
     {"_ganGenerativeData_dsGetNumberOfRows", (DL_FUNC) &_ganGenerativeData_dsGetNumberOfRows, 0},
     {"_ganGenerativeData_dsGetRow", (DL_FUNC) &_ganGenerativeData_dsGetRow, 1},
     {"_ganGenerativeData_dsGetNormalized", (DL_FUNC) &_ganGenerativeData_dsGetNormalized, 0},
-    {"_ganGenerativeData_dsIntCalculateDensityValues", (DL_FUNC) &_ganGenerativeData_dsIntCalculateDensityValues, 1},
+    {"_ganGenerativeData_dsIntCalculateDensityValues", (DL_FUNC) &_ganGenerativeData_dsIntCalculateDensityValues, 2},
+    {"_ganGenerativeData_dsCalculateOutlierScores", (DL_FUNC) &_ganGenerativeData_dsCalculateOutlierScores, 2},
+    {"_ganGenerativeData_dsIntCalculateOutlierScoresForRecords", (DL_FUNC) &_ganGenerativeData_dsIntCalculateOutlierScoresForRecords, 3},
     {"_ganGenerativeData_dsDensityValueInverseQuantile", (DL_FUNC) &_ganGenerativeData_dsDensityValueInverseQuantile, 1},
+    {"_ganGenerativeData_dsDensityValueQuantiles", (DL_FUNC) &_ganGenerativeData_dsDensityValueQuantiles, 2},
+    {"_ganGenerativeData_dsDensityValueInverseQuantiles", (DL_FUNC) &_ganGenerativeData_dsDensityValueInverseQuantiles, 2},
     {"_ganGenerativeData_gdReset", (DL_FUNC) &_ganGenerativeData_gdReset, 0},
     {"_ganGenerativeData_gdGetDataSourceFileName", (DL_FUNC) &_ganGenerativeData_gdGetDataSourceFileName, 0},
     {"_ganGenerativeData_gdGetGenerativeDataFileName", (DL_FUNC) &_ganGenerativeData_gdGetGenerativeDataFileName, 0},
@@ -682,16 +1041,27 @@ static const R_CallMethodDef CallEntries[] = {
     {"_ganGenerativeData_gdGenerativeDataRead", (DL_FUNC) &_ganGenerativeData_gdGenerativeDataRead, 1},
     {"_ganGenerativeData_gdGenerativeDataWrite", (DL_FUNC) &_ganGenerativeData_gdGenerativeDataWrite, 1},
     {"_ganGenerativeData_gdWriteSubset", (DL_FUNC) &_ganGenerativeData_gdWriteSubset, 2},
+    {"_ganGenerativeData_gdWriteRepresentativeSubset", (DL_FUNC) &_ganGenerativeData_gdWriteRepresentativeSubset, 2},
+    {"_ganGenerativeData_gdSetSeed", (DL_FUNC) &_ganGenerativeData_gdSetSeed, 1},
+    {"_ganGenerativeData_gdSetCompression", (DL_FUNC) &_ganGenerativeData_gdSetCompression, 1},
+    {"_ganGenerativeData_gdSetNumberOfNearestNeighbors", (DL_FUNC) &_ganGenerativeData_gdSetNumberOfNearestNeighbors, 1},
+    {"_ganGenerativeData_gdSetPageDirectory", (DL_FUNC) &_ganGenerativeData_gdSetPageDirectory, 1},
     {"_ganGenerativeData_gdCreateGenerativeData", (DL_FUNC) &_ganGenerativeData_gdCreateGenerativeData, 0},
     {"_ganGenerativeData_gdCreateDataSourceFromGenerativeModel", (DL_FUNC) &_ganGenerativeData_gdCreateDataSourceFromGenerativeModel, 0},
     {"_ganGenerativeData_gdDataSourceGetDataRandom", (DL_FUNC) &_ganGenerativeData_gdDataSourceGetDataRandom, 1},
     {"_ganGenerativeData_gdDataSourceGetNormalizedDataRandom", (DL_FUNC) &_ganGenerativeData_gdDataSourceGetNormalizedDataRandom, 1},
+    {"_ganGenerativeData_gdDataSourceGetNormalizedDataRandomMatrix", (DL_FUNC) &_ganGenerativeData_gdDataSourceGetNormalizedDataRandomMatrix, 1},
+    {"_ganGenerativeData_gdBatchSamplerStart", (DL_FUNC) &_ganGenerativeData_gdBatchSamplerStart, 2},
+    {"_ganGenerativeData_gdBatchSamplerNext", (DL_FUNC) &_ganGenerativeData_gdBatchSamplerNext, 2},
+    {"_ganGenerativeData_gdBatchSamplerStop", (DL_FUNC) &_ganGenerativeData_gdBatchSamplerStop, 0},
     {"_ganGenerativeData_gdDataSourceGetNormalizedDataRandomReference", (DL_FUNC) &_ganGenerativeData_gdDataSourceGetNormalizedDataRandomReference, 1},
     {"_ganGenerativeData_gdDataSourceGetDataRandomPercent", (DL_FUNC) &_ganGenerativeData_gdDataSourceGetDataRandomPercent, 1},
     {"_ganGenerativeData_gdGenerativeDataGetDenormalizedDataRandom", (DL_FUNC) &_ganGenerativeData_gdGenerativeDataGetDenormalizedDataRandom, 1},
     {"_ganGenerativeData_gdGenerativeDataGetDenormalizedDataRandomWithDensities", (DL_FUNC) &_ganGenerativeData_gdGenerativeDataGetDenormalizedDataRandomWithDensities, 1},
     {"_ganGenerativeData_gdGetDataSourceDimension", (DL_FUNC) &_ganGenerativeData_gdGetDataSourceDimension, 0},
     {"_ganGenerativeData_gdAddValueRows", (DL_FUNC) &_ganGenerativeData_gdAddValueRows, 1},
+    {"_ganGenerativeData_gdAddValueRowsWithThreshold", (DL_FUNC) &_ganGenerativeData_gdAddValueRowsWithThreshold, 3},
+    {"_ganGenerativeData_gdGetAcceptCounts", (DL_FUNC) &_ganGenerativeData_gdGetAcceptCounts, 0},
     {"_ganGenerativeData_gdGetNumberOfRows", (DL_FUNC) &_ganGenerativeData_gdGetNumberOfRows, 0},
     {"_ganGenerativeData_gdGetColumnNames", (DL_FUNC) &_ganGenerativeData_gdGetColumnNames, 1},
     {"_ganGenerativeData_gdGetGenerativeDataDimension", (DL_FUNC) &_ganGenerativeData_gdGetGenerativeDataDimension, 0},
@@ -700,10 +1070,21 @@ static const R_CallMethodDef CallEntries[] = {
     {"_ganGenerativeData_gdGetMax", (DL_FUNC) &_ganGenerativeData_gdGetMax, 1},
     {"_ganGenerativeData_gdGetMin", (DL_FUNC) &_ganGenerativeData_gdGetMin, 1},
     {"_ganGenerativeData_gdResetDensitiyValues", (DL_FUNC) &_ganGenerativeData_gdResetDensitiyValues, 0},
-    {"_ganGenerativeData_gdIntCalculateDensityValues", (DL_FUNC) &_ganGenerativeData_gdIntCalculateDensityValues, 0},
+    {"_ganGenerativeData_gdIntCalculateDensityValues", (DL_FUNC) &_ganGenerativeData_gdIntCalculateDensityValues, 2},
+    {"_ganGenerativeData_gdIntCalculateDensityValuesForNearestNeighbors", (DL_FUNC) &_ganGenerativeData_gdIntCalculateDensityValuesForNearestNeighbors, 1},
+    {"_ganGenerativeData_gdSelectDensityValues", (DL_FUNC) &_ganGenerativeData_gdSelectDensityValues, 1},
+    {"_ganGenerativeData_gdGetDensityNearestNeighbors", (DL_FUNC) &_ganGenerativeData_gdGetDensityNearestNeighbors, 0},
+    {"_ganGenerativeData_gdIntCalculateApproximateDensityValues", (DL_FUNC) &_ganGenerativeData_gdIntCalculateApproximateDensityValues, 2},
     {"_ganGenerativeData_gdCalculateDensityValue", (DL_FUNC) &_ganGenerativeData_gdCalculateDensityValue, 2},
+    {"_ganGenerativeData_gdIntCalculateDensityValuesForRecords", (DL_FUNC) &_ganGenerativeData_gdIntCalculateDensityValuesForRecords, 2},
+    {"_ganGenerativeData_gdCalculateOutlierScores", (DL_FUNC) &_ganGenerativeData_gdCalculateOutlierScores, 1},
+    {"_ganGenerativeData_gdIntCalculateOutlierScoresForRecords", (DL_FUNC) &_ganGenerativeData_gdIntCalculateOutlierScoresForRecords, 2},
+    {"_ganGenerativeData_gdIntCalculateClusters", (DL_FUNC) &_ganGenerativeData_gdIntCalculateClusters, 4},
+    {"_ganGenerativeData_gdGetClusterLabels", (DL_FUNC) &_ganGenerativeData_gdGetClusterLabels, 0},
     {"_ganGenerativeData_gdDensityValueQuantile", (DL_FUNC) &_ganGenerativeData_gdDensityValueQuantile, 1},
     {"_ganGenerativeData_gdDensityValueInverseQuantile", (DL_FUNC) &_ganGenerativeData_gdDensityValueInverseQuantile, 1},
+    {"_ganGenerativeData_gdDensityValueQuantiles", (DL_FUNC) &_ganGenerativeData_gdDensityValueQuantiles, 2},
+    {"_ganGenerativeData_gdDensityValueInverseQuantiles", (DL_FUNC) &_ganGenerativeData_gdDensityValueInverseQuantiles, 2},
     {"_ganGenerativeData_gdBuildFileName", (DL_FUNC) &_ganGenerativeData_gdBuildFileName, 2},
     {"_ganGenerativeData_gdKNearestNeighbors", (DL_FUNC) &_ganGenerativeData_gdKNearestNeighbors, 3},
     {"_ganGenerativeData_gdComplete", (DL_FUNC) &_ganGenerativeData_gdComplete, 2},
@@ -0,0 +1,227 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef BATCH_SAMPLER
+#define BATCH_SAMPLER
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "rng.h"
+#include "dataSource.h"
+
+using namespace std;
+
+const int cBatchRingSize = 4;
+const int cEpochBlockSize = 32;
+
+const uint64_t cIndexStream = 0;
+const uint64_t cNoiseStream = 1;
+const uint64_t cEpochStream = 2;
+const uint64_t cImputeStream = 3;
+
+const string cEmptyDataSource = "Data source is empty";
+const string cInvalidBatchSize = "Invalid batch size";
+
+// Row indices without replacement within an epoch. Each epoch the order of
+// blocks of cEpochBlockSize consecutive rows is shuffled and the rows of a
+// block are shuffled when the block is entered, so every row is returned
+// once per epoch while accesses stay near-contiguous. Only the block order
+// is stored.
+class EpochSampler {
+public:
+    EpochSampler(int size, uint32_t seed, int blockSize = cEpochBlockSize): _size(size), _blockSize(max(blockSize, 1)),
+        _blockOrder((size + _blockSize - 1) / _blockSize), _block(0), _row(0), _epoch(0), _generator(seed, cEpochStream) {
+        if(_size <= 0) {
+            throw string(cEmptyDataSource);
+        }
+        for(int i = 0; i < (int)_blockOrder.size(); i++) {
+            _blockOrder[i] = i;
+        }
+        startEpoch();
+    }
+
+    int operator()() {
+        if(_row == (int)_rows.size()) {
+            _block++;
+            if(_block == (int)_blockOrder.size()) {
+                _epoch++;
+                startEpoch();
+            } else {
+                startBlock();
+            }
+        }
+        return _rows[_row++];
+    }
+    int getEpoch() const {
+        return _epoch;
+    }
+
+private:
+    void startEpoch() {
+        _generator.shuffle(_blockOrder.begin(), _blockOrder.end());
+        _block = 0;
+        startBlock();
+    }
+    void startBlock() {
+        int begin = _blockOrder[_block] * _blockSize;
+        int end = min(begin + _blockSize, _size);
+        _rows.resize(end - begin);
+        for(int i = 0; i < (int)_rows.size(); i++) {
+            _rows[i] = begin + i;
+        }
+        _generator.shuffle(_rows.begin(), _rows.end());
+        _row = 0;
+    }
+
+    int _size;
+    int _blockSize;
+    vector<int> _blockOrder;
+    vector<int> _rows;
+    int _block;
+    int _row;
+    int _epoch;
+    Philox _generator;
+};
+
+// Producer thread filling a ring of batches of randomly selected normalized
+// rows of a data source together with batches of uniform noise in [-1, 1].
+// Rows are drawn with replacement or, when epochs are enabled, once per
+// epoch by an EpochSampler. Batches are gathered column-major from the
+// columns, so missing values are imputed anew each time a row is drawn as
+// in getNormalizedDataRandom. Rows, imputed values and noise are drawn from
+// separate streams of one seed, so the sequence of batches only depends on
+// the seed and not on thread timing. The data source must not be changed
+// while the sampler is running.
+class BatchSampler {
+public:
+    BatchSampler(DataSource& dataSource, int batchSize, int seed, bool epochs = false, int ringSize = cBatchRingSize): _dataSource(dataSource), _batchSize(batchSize), _dimension(dataSource.getDimension()),
+        _ring(max(ringSize, 1)), _head(0), _count(0), _stop(false), _indexGenerator((uint32_t)seed, cIndexStream),
+        _imputeGenerator((uint32_t)seed, cImputeStream), _indexVector(batchSize > 0 ? batchSize : 0), _noiseDistribution(Philox((uint32_t)seed, cNoiseStream), -1, 1), _pEpochSampler(0) {
+        if(_batchSize <= 0) {
+            throw string(cInvalidBatchSize);
+        }
+        if(dataSource.getNormalizedSize() == 0) {
+            throw string(cEmptyDataSource);
+        }
+        _noise.resize((size_t)_batchSize * _dimension);
+        if(epochs) {
+            _pEpochSampler = new EpochSampler(dataSource.getNormalizedSize(), (uint32_t)seed);
+        }
+        for(int i = 0; i < (int)_ring.size(); i++) {
+            _ring[i].samples.resize((size_t)_batchSize * _dimension);
+            _ring[i].noise.resize((size_t)_batchSize * _dimension);
+        }
+        _thread = thread(&BatchSampler::run, this);
+    }
+    ~BatchSampler() {
+        {
+            lock_guard<mutex> lock(_mutex);
+            _stop = true;
+        }
+        _notFull.notify_all();
+        _thread.join();
+        delete _pEpochSampler;
+    }
+
+    int getBatchSize() const {
+        return _batchSize;
+    }
+    int getDimension() const {
+        return _dimension;
+    }
+
+    // Copy the next batch of samples and noise, each batchSize * dimension values
+    void next(double* samples, double* noise) {
+        unique_lock<mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this]{ return _count > 0 || !_error.empty(); });
+        if(_count == 0) {
+            throw string(_error);
+        }
+
+        Batch& batch = _ring[_head];
+        lock.unlock();
+        copy(batch.samples.begin(), batch.samples.end(), samples);
+        copy(batch.noise.begin(), batch.noise.end(), noise);
+        lock.lock();
+
+        _head = (_head + 1) % _ring.size();
+        _count--;
+        lock.unlock();
+        _notFull.notify_one();
+    }
+
+private:
+    struct Batch {
+        vector<double> samples;
+        vector<double> noise;
+    };
+
+    void run() {
+        try {
+            size_t tail = 0;
+            while(true) {
+                {
+                    unique_lock<mutex> lock(_mutex);
+                    _notFull.wait(lock, [this]{ return _count < _ring.size() || _stop; });
+                    if(_stop) {
+                        return;
+                    }
+                }
+
+                fill(_ring[tail]);
+
+                {
+                    lock_guard<mutex> lock(_mutex);
+                    _count++;
+                }
+                _notEmpty.notify_one();
+                tail = (tail + 1) % _ring.size();
+            }
+        } catch(const string& e) {
+            setError(e);
+        } catch(...) {
+            setError("C++ exception (unknown reason)");
+        }
+    }
+    void fill(Batch& batch) {
+        for(int i = 0; i < _batchSize; i++) {
+            _indexVector[i] = _pEpochSampler != 0 ? (*_pEpochSampler)() : _indexGenerator.bounded(_dataSource.getNormalizedSize());
+        }
+        _dataSource.getNormalizedNumberMatrix(_indexVector, batch.samples.data(), _imputeGenerator);
+        _noiseDistribution.fill(_noise.data(), _noise.size());
+        copy(_noise.begin(), _noise.end(), batch.noise.begin());
+    }
+    void setError(const string& error) {
+        {
+            lock_guard<mutex> lock(_mutex);
+            _error = error;
+        }
+        _notEmpty.notify_all();
+    }
+
+    DataSource& _dataSource;
+    int _batchSize;
+    int _dimension;
+
+    vector<Batch> _ring;
+    size_t _head;
+    size_t _count;
+    bool _stop;
+    string _error;
+
+    mutex _mutex;
+    condition_variable _notEmpty;
+    condition_variable _notFull;
+    thread _thread;
+
+    Philox _indexGenerator;
+    Philox _imputeGenerator;
+    vector<int> _indexVector;
+    UniformRealDistribution _noiseDistribution;
+    vector<float> _noise;
+    EpochSampler* _pEpochSampler;
+};
+
+#endif
@@ -0,0 +1,348 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef CLUSTERING
+#define CLUSTERING
+
+#include <atomic>
+#include <algorithm>
+
+#include "dataSource.h"
+#include "vpTree.h"
+#include "parallel.h"
+#include "density.h"
+
+const float cClusterMinDistance = 1e-10;
+
+const string cInvalidRadius = "Invalid radius";
+const string cInvalidMinPoints = "Invalid minimum number of points";
+const string cInvalidMinClusterSize = "Invalid minimum cluster size";
+
+// Density based clustering of the normalized rows of a data source. Cluster
+// labels are numbered from 1 in order of the first row of a cluster, 0
+// denotes noise. As for density values a row is its own nearest neighbor
+// and counts for the number of points of its neighborhood.
+class Clustering {
+public:
+    Clustering(DataSource& dataSource, VpTree* vpTree, int numberOfThreads = 0) : _dataSource(dataSource), _vpTree(vpTree), _parallelFor(numberOfThreads) {}
+
+    // DBSCAN: rows with at least minPoints rows within radius are core rows,
+    // core rows within radius of each other are in the same cluster and
+    // other rows within radius of a core row are border rows of its cluster.
+    // Core rows are taken from the graph of the data source if it holds
+    // minPoints nearest neighbors, otherwise they are counted with range
+    // searches. Core rows are connected with range searches on
+    // numberOfThreads threads in a concurrent union find, a border row goes
+    // to the cluster of its core row with the smallest index, so labels do
+    // not depend on the order of execution. The tree has to be built.
+    vector<int> calculateDbscanLabels(float radius, int minPoints) {
+        if(!(radius >= 0)) {
+            throw string(cInvalidRadius);
+        }
+        if(minPoints <= 0) {
+            throw string(cInvalidMinPoints);
+        }
+
+        int n = _dataSource.getNormalizedSize();
+        int blockCount = (n + cDensityBlockSize - 1) / cDensityBlockSize;
+        vector<char> core(n, 0);
+        if(_dataSource.hasKnnGraph(minPoints)) {
+            const KnnGraph& knnGraph = _dataSource.getKnnGraph();
+            for(int i = 0; i < n; i++) {
+                core[i] = knnGraph.getNeighborCount(i) >= minPoints && knnGraph.getDistances(i)[minPoints - 1] <= radius;
+            }
+        } else {
+            _parallelFor(blockCount, [&](int b) {
+                vector<int> indices;
+                int end = min(n, (b + 1) * cDensityBlockSize);
+                for(int i = b * cDensityBlockSize; i < end; i++) {
+                    _vpTree->rangeSearch(_dataSource.getNormalizedRowData(i), radius, indices);
+                    core[i] = (int)indices.size() >= minPoints;
+                }
+            });
+        }
+
+        vector<atomic<int> > parents(n);
+        vector<atomic<int> > borderCores(n);
+        for(int i = 0; i < n; i++) {
+            parents[i] = i;
+            borderCores[i] = n;
+        }
+        _parallelFor(blockCount, [&](int b) {
+            vector<int> indices;
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                if(!core[i]) {
+                    continue;
+                }
+                _vpTree->rangeSearch(_dataSource.getNormalizedRowData(i), radius, indices);
+                for(int j : indices) {
+                    if(core[j]) {
+                        if(j > i) {
+                            unite(parents, i, j);
+                        }
+                    } else {
+                        int borderCore = borderCores[j];
+                        while(i < borderCore && !borderCores[j].compare_exchange_weak(borderCore, i)) {
+                            ;
+                        }
+                    }
+                }
+            }
+        });
+
+        vector<int> clusters(n, -1);
+        for(int i = 0; i < n; i++) {
+            if(core[i]) {
+                clusters[i] = find(parents, i);
+            } else if(borderCores[i] < n) {
+                clusters[i] = find(parents, borderCores[i]);
+            }
+        }
+        return getLabels(clusters);
+    }
+
+    // Clusters of a hierarchy in the style of HDBSCAN. The mutual
+    // reachability distance of two rows is the maximum of their distance and
+    // their core distances, the distances to their minPoints-th nearest
+    // neighbor. A minimum spanning forest of mutual reachability distances on
+    // the edges of the nearest neighbor graph gives a single linkage
+    // hierarchy, in which clusters of less than minClusterSize rows are
+    // condensed into their parent clusters. From the condensed hierarchy the
+    // clusters with the largest sum of stabilities are selected, the
+    // stability of a cluster sums 1 / distance over the rows leaving it minus
+    // 1 / distance at its birth. The graph of the data source is used if it
+    // holds minPoints nearest neighbors, otherwise it is searched in the tree.
+    vector<int> calculateHierarchicalLabels(int minPoints, int minClusterSize) {
+        if(minPoints <= 0) {
+            throw string(cInvalidMinPoints);
+        }
+        if(minClusterSize < 2) {
+            throw string(cInvalidMinClusterSize);
+        }
+
+        KnnGraph searchedGraph;
+        const KnnGraph* pKnnGraph = &_dataSource.getKnnGraph();
+        if(!_dataSource.hasKnnGraph(minPoints)) {
+            Density density(_dataSource, _vpTree, minPoints, 0);
+            density.calculateKnnGraph(searchedGraph, _parallelFor.getNumberOfThreads());
+            pKnnGraph = &searchedGraph;
+        }
+        const KnnGraph& knnGraph = *pKnnGraph;
+
+        int n = knnGraph.getSize();
+        vector<float> coreDistances(n, 0);
+        for(int i = 0; i < n; i++) {
+            int count = min(minPoints, knnGraph.getNeighborCount(i));
+            if(count > 0) {
+                coreDistances[i] = knnGraph.getDistances(i)[count - 1];
+            }
+        }
+
+        // Edges of the graph, an edge listed for both rows is taken once
+        vector<Edge> edges;
+        for(int i = 0; i < n; i++) {
+            const int* indices = knnGraph.getIndices(i);
+            const float* distances = knnGraph.getDistances(i);
+            for(int j = 0; j < knnGraph.getNeighborCount(i); j++) {
+                int k = indices[j];
+                if(k == i || (k < i && contains(knnGraph, k, i))) {
+                    continue;
+                }
+                float distance = max(distances[j], max(coreDistances[i], coreDistances[k]));
+                edges.push_back(Edge(distance, min(i, k), max(i, k)));
+            }
+        }
+        sort(edges.begin(), edges.end());
+
+        // Single linkage hierarchy, nodes below n are rows
+        vector<int> parents(n);
+        vector<int> componentNodes(n);
+        for(int i = 0; i < n; i++) {
+            parents[i] = i;
+            componentNodes[i] = i;
+        }
+        vector<int> sizes(n, 1);
+        vector<int> lefts, rights;
+        vector<float> nodeDistances;
+        for(const Edge& edge : edges) {
+            int a = find(parents, edge.i);
+            int b = find(parents, edge.j);
+            if(a == b) {
+                continue;
+            }
+            int left = componentNodes[a];
+            int right = componentNodes[b];
+            lefts.push_back(left);
+            rights.push_back(right);
+            nodeDistances.push_back(edge.distance);
+            sizes.push_back(sizes[left] + sizes[right]);
+            parents[max(a, b)] = min(a, b);
+            componentNodes[min(a, b)] = sizes.size() - 1;
+        }
+
+        // Condense the hierarchy top down. Roots are components of the forest.
+        int nodeCount = sizes.size();
+        vector<char> hasParent(nodeCount, 0);
+        for(int m = 0; m < (int)lefts.size(); m++) {
+            hasParent[lefts[m]] = 1;
+            hasParent[rights[m]] = 1;
+        }
+        vector<int> nodeClusters(nodeCount, -1);
+        vector<int> fallenClusters(nodeCount, -1);
+        vector<int> clusterParents;
+        vector<double> births, stabilities;
+        auto addCluster = [&](int parent, double birth) {
+            clusterParents.push_back(parent);
+            births.push_back(birth);
+            stabilities.push_back(0);
+            return (int)clusterParents.size() - 1;
+        };
+        for(int node = nodeCount - 1; node >= n; node--) {
+            if(!hasParent[node] && sizes[node] >= minClusterSize) {
+                nodeClusters[node] = addCluster(-1, 0);
+            }
+            int m = node - n;
+            int children[2] = {lefts[m], rights[m]};
+            int c = nodeClusters[node];
+            if(c < 0) {
+                fallenClusters[children[0]] = fallenClusters[children[1]] = fallenClusters[node];
+                continue;
+            }
+            double lambda = 1.0 / max(nodeDistances[m], cClusterMinDistance);
+            if(sizes[children[0]] >= minClusterSize && sizes[children[1]] >= minClusterSize) {
+                stabilities[c] += sizes[node] * (lambda - births[c]);
+                nodeClusters[children[0]] = addCluster(c, lambda);
+                nodeClusters[children[1]] = addCluster(c, lambda);
+            } else {
+                for(int child : children) {
+                    if(sizes[child] >= minClusterSize) {
+                        nodeClusters[child] = c;
+                    } else {
+                        stabilities[c] += sizes[child] * (lambda - births[c]);
+                        fallenClusters[child] = c;
+                    }
+                }
+            }
+        }
+
+        // Select clusters bottom up, a root cluster with children is not selected
+        int clusterCount = clusterParents.size();
+        vector<char> selected(clusterCount, 0);
+        vector<char> hasChildren(clusterCount, 0);
+        vector<double> childStabilities(clusterCount, 0);
+        for(int c = clusterCount - 1; c >= 0; c--) {
+            double stability = childStabilities[c];
+            if(!hasChildren[c] || (clusterParents[c] >= 0 && stabilities[c] >= childStabilities[c])) {
+                selected[c] = 1;
+                stability = stabilities[c];
+            }
+            if(clusterParents[c] >= 0) {
+                hasChildren[clusterParents[c]] = 1;
+                childStabilities[clusterParents[c]] += stability;
+            }
+        }
+        // Rows are labeled with the selected cluster they left or its nearest selected ancestor
+        vector<int> labelClusters(clusterCount, -1);
+        for(int c = 0; c < clusterCount; c++) {
+            int parent = clusterParents[c];
+            int parentLabelCluster = parent >= 0 ? labelClusters[parent] : -1;
+            labelClusters[c] = parentLabelCluster < 0 && selected[c] ? c : parentLabelCluster;
+        }
+        vector<int> clusters(n, -1);
+        for(int i = 0; i < n; i++) {
+            if(fallenClusters[i] >= 0) {
+                clusters[i] = labelClusters[fallenClusters[i]];
+            }
+        }
+        return getLabels(clusters);
+    }
+
+private:
+    struct Edge {
+        Edge(float d, int a, int b): distance(d), i(a), j(b) {}
+
+        bool operator<(const Edge& edge) const {
+            if(distance != edge.distance) {
+                return distance < edge.distance;
+            }
+            return i != edge.i ? i < edge.i : j < edge.j;
+        }
+
+        float distance;
+        int i;
+        int j;
+    };
+
+    static bool contains(const KnnGraph& knnGraph, int i, int k) {
+        const int* indices = knnGraph.getIndices(i);
+        return std::find(indices, indices + knnGraph.getNeighborCount(i), k) != indices + knnGraph.getNeighborCount(i);
+    }
+
+    static int find(vector<int>& parents, int i) {
+        while(parents[i] != i) {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+
+    // Roots are linked to the smaller root, a link only succeeds while the
+    // linked row is still a root
+    static int find(vector<atomic<int> >& parents, int i) {
+        while(true) {
+            int parent = parents[i];
+            if(parent == i) {
+                return i;
+            }
+            int grandParent = parents[parent];
+            if(parent != grandParent) {
+                parents[i].compare_exchange_weak(parent, grandParent);
+            }
+            i = grandParent;
+        }
+    }
+    static void unite(vector<atomic<int> >& parents, int i, int j) {
+        while(true) {
+            i = find(parents, i);
+            j = find(parents, j);
+            if(i == j) {
+                return;
+            }
+            if(i < j) {
+                swap(i, j);
+            }
+            int expected = i;
+            if(parents[i].compare_exchange_strong(expected, j)) {
+                return;
+            }
+        }
+    }
+
+    // Labels numbered from 1 in order of first appearance, -1 becomes 0
+    static vector<int> getLabels(const vector<int>& clusters) {
+        vector<int> labels(clusters.size(), 0);
+        vector<int> clusterLabels;
+        int labelCount = 0;
+        for(int i = 0; i < (int)clusters.size(); i++) {
+            int c = clusters[i];
+            if(c < 0) {
+                continue;
+            }
+            if(c >= (int)clusterLabels.size()) {
+                clusterLabels.resize(c + 1, 0);
+            }
+            if(clusterLabels[c] == 0) {
+                clusterLabels[c] = ++labelCount;
+            }
+            labels[i] = clusterLabels[c];
+        }
+        return labels;
+    }
+
+    DataSource& _dataSource;
+    VpTree* _vpTree;
+    ParallelFor _parallelFor;
+};
+
+#endif
@@ -0,0 +1,312 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef BLOCK_CODEC
+#define BLOCK_CODEC
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+const int cCodecBlockSize = 1 << 16;
+const int cCodecTrialSize = 1 << 12;
+const int cLzHashBits = 14;
+const size_t cLzMinMatch = 4;
+const size_t cLzMaxOffset = 1 << 20;
+
+const string cInvalidCodec = "Invalid codec";
+const string cCorruptBlock = "Corrupt compressed block";
+
+// Codec for blocks of 32-bit words of columns. A block is either stored raw,
+// bit-packed relative to its minimum, bit-packed as zigzag encoded deltas or
+// byte-shuffled and compressed with a simple LZ77 scheme. The codec with the
+// smallest result is chosen per block, the LZ codec only when a trial on the
+// beginning of the block promises a gain.
+class BlockCodec {
+public:
+    enum CODEC {
+        RAW,
+        BITPACK,
+        DELTA_BITPACK,
+        SHUFFLE_LZ
+    };
+
+    CODEC encode(const void* p, int n, bool compression, vector<unsigned char>& out) {
+        vector<uint32_t> w(n);
+        memcpy(w.data(), p, sizeof(uint32_t) * n);
+
+        out.clear();
+        size_t rawSize = sizeof(uint32_t) * n;
+        if(!compression || n < 2) {
+            encodeRaw(w, out);
+            return RAW;
+        }
+
+        uint32_t min = *min_element(w.begin(), w.end());
+        uint32_t max = *max_element(w.begin(), w.end());
+        int bitpackWidth = getWidth(max - min);
+        int deltaWidth = 0;
+        for(int i = 1; i < n; i++) {
+            deltaWidth = std::max(deltaWidth, getWidth(zigzag(w[i] - w[i - 1])));
+        }
+        size_t bitpackSize = 5 + ((size_t)n * bitpackWidth + 7) / 8;
+        size_t deltaSize = 5 + ((size_t)(n - 1) * deltaWidth + 7) / 8;
+
+        CODEC codec = RAW;
+        size_t size = rawSize;
+        if(bitpackSize < size) {
+            codec = BITPACK;
+            size = bitpackSize;
+        }
+        if(deltaSize < size) {
+            codec = DELTA_BITPACK;
+            size = deltaSize;
+        }
+
+        int m = std::min(n, cCodecTrialSize);
+        vector<unsigned char> trial;
+        encodeShuffleLz(w.data(), m, trial);
+        if((double)trial.size() / (double)m * (double)n < (double)size) {
+            encodeShuffleLz(w.data(), n, out);
+            if(out.size() < size) {
+                return SHUFFLE_LZ;
+            }
+            out.clear();
+        }
+
+        if(codec == BITPACK) {
+            encodeBitpack(w, min, bitpackWidth, out);
+        } else if(codec == DELTA_BITPACK) {
+            encodeDeltaBitpack(w, deltaWidth, out);
+        } else {
+            encodeRaw(w, out);
+        }
+        return codec;
+    }
+
+    void decode(int codec, const unsigned char* in, size_t size, void* p, int n) {
+        vector<uint32_t> w(n);
+        if(codec == RAW) {
+            if(size != sizeof(uint32_t) * (size_t)n) {
+                throw string(cCorruptBlock);
+            }
+            for(int i = 0; i < n; i++) {
+                w[i] = load(in + sizeof(uint32_t) * i);
+            }
+        } else if(codec == BITPACK) {
+            if(size < 5 || in[4] > 32 || size < 5 + ((size_t)n * in[4] + 7) / 8) {
+                throw string(cCorruptBlock);
+            }
+            uint32_t min = load(in);
+            unpack(in + 5, in[4], w.data(), n);
+            for(int i = 0; i < n; i++) {
+                w[i] += min;
+            }
+        } else if(codec == DELTA_BITPACK) {
+            if(n == 0) {
+                return;
+            }
+            if(size < 5 || in[4] > 32 || size < 5 + ((size_t)(n - 1) * in[4] + 7) / 8) {
+                throw string(cCorruptBlock);
+            }
+            w[0] = load(in);
+            unpack(in + 5, in[4], w.data() + 1, n - 1);
+            for(int i = 1; i < n; i++) {
+                w[i] = w[i - 1] + unzigzag(w[i]);
+            }
+        } else if(codec == SHUFFLE_LZ) {
+            vector<unsigned char> shuffled(sizeof(uint32_t) * n);
+            decompressLz(in, size, shuffled.data(), shuffled.size());
+            for(int i = 0; i < n; i++) {
+                w[i] = (uint32_t)shuffled[i] | (uint32_t)shuffled[n + i] << 8 |
+                    (uint32_t)shuffled[2 * n + i] << 16 | (uint32_t)shuffled[3 * n + i] << 24;
+            }
+        } else {
+            throw string(cInvalidCodec);
+        }
+        memcpy(p, w.data(), sizeof(uint32_t) * n);
+    }
+
+private:
+    static uint32_t load(const unsigned char* p) {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    static void store(vector<unsigned char>& out, uint32_t x) {
+        out.push_back((unsigned char)x);
+        out.push_back((unsigned char)(x >> 8));
+        out.push_back((unsigned char)(x >> 16));
+        out.push_back((unsigned char)(x >> 24));
+    }
+    static int getWidth(uint32_t x) {
+        int width = 0;
+        while(x != 0) {
+            width++;
+            x >>= 1;
+        }
+        return width;
+    }
+    static uint32_t zigzag(uint32_t d) {
+        return (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+    }
+    static uint32_t unzigzag(uint32_t z) {
+        return (z >> 1) ^ (uint32_t)(-(int32_t)(z & 1));
+    }
+
+    void encodeRaw(const vector<uint32_t>& w, vector<unsigned char>& out) {
+        out.reserve(sizeof(uint32_t) * w.size());
+        for(int i = 0; i < (int)w.size(); i++) {
+            store(out, w[i]);
+        }
+    }
+    void pack(const uint32_t* w, int n, int width, vector<unsigned char>& out) {
+        uint64_t buffer = 0;
+        int bits = 0;
+        for(int i = 0; i < n; i++) {
+            buffer |= (uint64_t)w[i] << bits;
+            bits += width;
+            while(bits >= 8) {
+                out.push_back((unsigned char)buffer);
+                buffer >>= 8;
+                bits -= 8;
+            }
+        }
+        if(bits > 0) {
+            out.push_back((unsigned char)buffer);
+        }
+    }
+    void unpack(const unsigned char* in, int width, uint32_t* w, int n) {
+        uint64_t buffer = 0;
+        int bits = 0;
+        uint64_t mask = width == 32 ? 0xFFFFFFFFull : ((uint64_t)1 << width) - 1;
+        for(int i = 0; i < n; i++) {
+            while(bits < width) {
+                buffer |= (uint64_t)(*in++) << bits;
+                bits += 8;
+            }
+            w[i] = (uint32_t)(buffer & mask);
+            buffer >>= width;
+            bits -= width;
+        }
+    }
+    void encodeBitpack(const vector<uint32_t>& w, uint32_t min, int width, vector<unsigned char>& out) {
+        vector<uint32_t> d(w.size());
+        for(int i = 0; i < (int)w.size(); i++) {
+            d[i] = w[i] - min;
+        }
+        store(out, min);
+        out.push_back((unsigned char)width);
+        pack(d.data(), d.size(), width, out);
+    }
+    void encodeDeltaBitpack(const vector<uint32_t>& w, int width, vector<unsigned char>& out) {
+        vector<uint32_t> d(w.size() - 1);
+        for(int i = 1; i < (int)w.size(); i++) {
+            d[i - 1] = zigzag(w[i] - w[i - 1]);
+        }
+        store(out, w[0]);
+        out.push_back((unsigned char)width);
+        pack(d.data(), d.size(), width, out);
+    }
+
+    void encodeShuffleLz(const uint32_t* w, int n, vector<unsigned char>& out) {
+        vector<unsigned char> shuffled(sizeof(uint32_t) * n);
+        for(int i = 0; i < n; i++) {
+            shuffled[i] = (unsigned char)w[i];
+            shuffled[n + i] = (unsigned char)(w[i] >> 8);
+            shuffled[2 * n + i] = (unsigned char)(w[i] >> 16);
+            shuffled[3 * n + i] = (unsigned char)(w[i] >> 24);
+        }
+        out.clear();
+        compressLz(shuffled.data(), shuffled.size(), out);
+    }
+
+    static void putVarint(vector<unsigned char>& out, size_t x) {
+        while(x >= 0x80) {
+            out.push_back((unsigned char)(x | 0x80));
+            x >>= 7;
+        }
+        out.push_back((unsigned char)x);
+    }
+    static size_t getVarint(const unsigned char*& in, const unsigned char* end) {
+        size_t x = 0;
+        int shift = 0;
+        while(true) {
+            if(in >= end || shift > 56) {
+                throw string(cCorruptBlock);
+            }
+            unsigned char c = *in++;
+            x |= (size_t)(c & 0x7F) << shift;
+            if((c & 0x80) == 0) {
+                return x;
+            }
+            shift += 7;
+        }
+    }
+
+    // Sequences of a literal count, literals, match length minus minimum match
+    // and match offset. The last sequence may consist of literals only.
+    void compressLz(const unsigned char* in, size_t n, vector<unsigned char>& out) {
+        vector<int64_t> table((size_t)1 << cLzHashBits, -1);
+        size_t anchor = 0;
+        size_t i = 0;
+        while(i + cLzMinMatch <= n) {
+            uint32_t v = load(in + i);
+            uint32_t h = (v * 2654435761u) >> (32 - cLzHashBits);
+            int64_t candidate = table[h];
+            table[h] = i;
+            if(candidate >= 0 && i - candidate <= cLzMaxOffset && load(in + candidate) == v) {
+                size_t length = cLzMinMatch;
+                while(i + length < n && in[candidate + length] == in[i + length]) {
+                    length++;
+                }
+                putVarint(out, i - anchor);
+                out.insert(out.end(), in + anchor, in + i);
+                putVarint(out, length - cLzMinMatch);
+                putVarint(out, i - candidate);
+                i += length;
+                anchor = i;
+            } else {
+                i += 1 + ((i - anchor) >> 6);
+            }
+        }
+        if(anchor < n) {
+            putVarint(out, n - anchor);
+            out.insert(out.end(), in + anchor, in + n);
+        }
+    }
+    void decompressLz(const unsigned char* in, size_t size, unsigned char* out, size_t n) {
+        const unsigned char* end = in + size;
+        size_t o = 0;
+        while(o < n) {
+            size_t literals = getVarint(in, end);
+            if(literals > n - o || literals > (size_t)(end - in)) {
+                throw string(cCorruptBlock);
+            }
+            memcpy(out + o, in, literals);
+            in += literals;
+            o += literals;
+            if(o == n) {
+                break;
+            }
+
+            size_t length = getVarint(in, end) + cLzMinMatch;
+            size_t offset = getVarint(in, end);
+            if(offset == 0 || offset > o || length > n - o) {
+                throw string(cCorruptBlock);
+            }
+            if(offset >= length) {
+                memcpy(out + o, out + o - offset, length);
+            } else {
+                for(size_t j = 0; j < length; j++) {
+                    out[o + j] = out[o + j - offset];
+                }
+            }
+            o += length;
+        }
+    }
+};
+
+#endif
@@ -5,6 +5,7 @@
 #define COLUMN
 
 #include "inOut.h"
+#include "rng.h"
 
 using namespace std;
 
@@ -28,9 +29,9 @@ public:
         NOMINAL
     };
   
-	Column(const COLUMN_TYPE type, const SCALE_TYPE scaleType): _type(type), _scaleType(scaleType), _name(L""), _active(true) {
+	Column(const COLUMN_TYPE type, const SCALE_TYPE scaleType): _type(type), _scaleType(scaleType), _name(""), _active(true) {
 	}
-	Column(const COLUMN_TYPE type, const SCALE_TYPE scaleType, const wstring& name, bool active): _type(type),  _scaleType(scaleType), _name(name), _active(active) {
+	Column(const COLUMN_TYPE type, const SCALE_TYPE scaleType, const string& name, bool active): _type(type),  _scaleType(scaleType), _name(name), _active(active) {
 	}
 	virtual ~Column() {
 	}
@@ -42,6 +43,36 @@ public:
 	virtual int getDimension() const = 0;
 	virtual int getSize() = 0;
 	virtual int getNormalizedSize() = 0;
+
+	// Append normalized values of rowCount rows, or of the rowCount rows in
+	// indices if indices is not 0. The values of this column start at p,
+	// consecutive rows are separated by rowStride and consecutive dimensions
+	// by dimensionStride.
+	virtual void addNormalizedValues(const double* p, int rowCount, const int* indices, int rowStride, int dimensionStride) {
+		throw string(cInvalidColumnType);
+	}
+	virtual void reserveNormalized(int size) {
+	}
+	// Keep the values in page files of pageDirectory instead of memory, empty
+	// for memory. Present values are moved.
+	virtual void setPageDirectory(const string& pageDirectory) {
+	}
+
+	// Write normalized values of the rows in indexVector column-major to p,
+	// values of a dimension are separated by stride
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride) {
+		for(int i = 0; i < (int)indexVector.size(); i++) {
+			vector<float> numberVector = getNormalizedNumberVector(indexVector[i]);
+			for(int j = 0; j < (int)numberVector.size(); j++) {
+				p[j * stride + i] = numberVector[j];
+			}
+		}
+	}
+	// As above with missing values imputed from generator instead of the
+	// distributions of the column, so rows can be gathered on another thread
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride, Philox& generator) {
+		getNormalizedNumberMatrix(indexVector, p, stride);
+	}
 	
 	const COLUMN_TYPE getColumnType() const {
 		return _type;
@@ -49,10 +80,10 @@ public:
 	const SCALE_TYPE getScaleType() const {
 	    return _scaleType;
 	}
-	void setName(const wstring& name) {
+	void setName(const string& name) {
 	    _name = name;
 	}
-	const wstring getName() const {
+	const string getName() const {
 		return _name;
 	}
 	void setActive(bool active) {
@@ -62,15 +93,15 @@ public:
 		return _active;
 	}
 
-	virtual void write(ofstream& os) {
+	virtual void write(OutStream& os) {
 		InOut::Write(os, _name);
 		InOut::Write(os, _active);
 		
 		int st = static_cast<int>(_scaleType);
 		InOut::Write(os, st);
 	}
-	virtual void read(ifstream& is) {
-		InOut::Read(is, _name);
+	virtual void read(InStream& is) {
+		InOut::ReadText(is, _name);
 		InOut::Read(is, _active);
 		
 		int st = 0;
@@ -81,7 +112,7 @@ public:
 protected:
 	COLUMN_TYPE _type;
     SCALE_TYPE _scaleType;
-	wstring _name;
+	string _name;
 	bool _active;
 };
 
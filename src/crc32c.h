@@ -0,0 +1,72 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef CRC32C
+#define CRC32C
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// CRC-32C (Castagnoli) checksum, computed in software with slicing-by-8
+class Crc32c {
+public:
+    Crc32c(): _crc(0xFFFFFFFF) {
+    }
+
+    void reset() {
+        _crc = 0xFFFFFFFF;
+    }
+    void update(const char* p, size_t size) {
+        const uint32_t (*t)[256] = getTable();
+        const unsigned char* q = (const unsigned char *)p;
+        uint32_t crc = _crc;
+
+        while(size >= 8) {
+            uint32_t a = crc ^ ((uint32_t)q[0] | (uint32_t)q[1] << 8 | (uint32_t)q[2] << 16 | (uint32_t)q[3] << 24);
+            uint32_t b = (uint32_t)q[4] | (uint32_t)q[5] << 8 | (uint32_t)q[6] << 16 | (uint32_t)q[7] << 24;
+            crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+                t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+            q += 8;
+            size -= 8;
+        }
+        while(size > 0) {
+            crc = t[0][(crc ^ *q) & 0xFF] ^ (crc >> 8);
+            q++;
+            size--;
+        }
+        _crc = crc;
+    }
+    uint32_t get() const {
+        return _crc ^ 0xFFFFFFFF;
+    }
+
+private:
+    static const uint32_t (*getTable())[256] {
+        static Table table;
+        return table._t;
+    }
+
+    struct Table {
+        Table() {
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for(int j = 0; j < 8; j++) {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+                }
+                _t[0][i] = crc;
+            }
+            for(uint32_t i = 0; i < 256; i++) {
+                for(int j = 1; j < 8; j++) {
+                    _t[j][i] = _t[0][_t[j - 1][i] & 0xFF] ^ (_t[j - 1][i] >> 8);
+                }
+            }
+        }
+        uint32_t _t[8][256];
+    };
+
+    uint32_t _crc;
+};
+
+#endif
@@ -0,0 +1,374 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef CSV_READER
+#define CSV_READER
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <unordered_map>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#include "mappedFile.h"
+#include "parallel.h"
+#include "dataSource.h"
+
+using namespace std;
+
+const size_t cCsvChunkSize = 1 << 22;
+
+const string cCsvNoHeader = "CSV file has no header";
+const string cCsvInvalidFieldCount = "Invalid number of fields in CSV file";
+const string cCsvUnknownColumn = "Column not found in CSV file:";
+const string cCsvDuplicateColumn = "Duplicate column name in CSV file:";
+
+// Reader creating a data source from a CSV file with a header line. The file
+// is mapped into memory and split into chunks at line ends, chunks are parsed
+// in parallel. A column is numerical when all its values are numbers or
+// missing, otherwise it is of type string. Empty fields and NA denote
+// missing values. Fields may be quoted, quotes within quoted fields are
+// escaped by doubling. Values of string columns are collected per chunk in
+// order of first appearance and merged in chunk order, so the resulting data
+// source is the same as one created row by row.
+class CsvReader {
+public:
+    CsvReader(char separator = ',', int numberOfThreads = 0): _separator(separator), _parallelFor(numberOfThreads) {
+    }
+
+    // Read the columns with columnNames in that order, all columns if empty
+    DataSource* read(const string& fileName, const vector<string>& columnNames = vector<string>()) {
+        MappedFile file;
+        if(!file.open(fileName)) {
+            throw string("File " + fileName + " could not be opened");
+        }
+        const char* p = file.getData();
+        const char* end = p + file.getSize();
+        if(end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+            p += 3;
+        }
+
+        vector<string> header;
+        p = skipEmptyLines(p, end);
+        if(p == end) {
+            throw string(cCsvNoHeader);
+        }
+        p = readLine(p, end, header);
+
+        vector<string> names;
+        _fieldColumn.assign(header.size(), -1);
+        if(columnNames.empty()) {
+            checkUniqueNames(header);
+            for(int i = 0; i < (int)header.size(); i++) {
+                _fieldColumn[i] = i;
+            }
+            names = header;
+        } else {
+            checkUniqueNames(columnNames);
+            for(int i = 0; i < (int)columnNames.size(); i++) {
+                vector<string>::iterator it = find(header.begin(), header.end(), columnNames[i]);
+                if(it == header.end()) {
+                    throw string(cCsvUnknownColumn + " " + columnNames[i]);
+                }
+                if(find(it + 1, header.end(), columnNames[i]) != header.end()) {
+                    throw string(cCsvDuplicateColumn + " " + columnNames[i]);
+                }
+                _fieldColumn[it - header.begin()] = i;
+            }
+            names = columnNames;
+        }
+        _fieldCount = header.size();
+        _columnCount = names.size();
+        _numerical.clear();
+
+        vector<Chunk> chunks;
+        split(p, end, chunks);
+
+        _parallelFor((int)chunks.size(), [&](int c) {
+            inferTypes(chunks[c]);
+        });
+        vector<Column::COLUMN_TYPE> columnTypes(_columnCount, Column::STRING);
+        for(int j = 0; j < _columnCount; j++) {
+            int type = NA;
+            for(int c = 0; c < (int)chunks.size(); c++) {
+                type = max(type, (int)chunks[c].types[j]);
+            }
+            _numerical.push_back(type == NUMBER);
+            if(type == NUMBER) {
+                columnTypes[j] = Column::NUMERICAL;
+            }
+        }
+
+        _parallelFor((int)chunks.size(), [&](int c) {
+            parse(chunks[c]);
+        });
+
+        DataSource* pDataSource = new DataSource(columnTypes, names);
+        try {
+            for(int j = 0; j < _columnCount; j++) {
+                for(int c = 0; c < (int)chunks.size(); c++) {
+                    Chunk& chunk = chunks[c];
+                    if(_numerical[j]) {
+                        pDataSource->addNumberColumnValues(j, chunk.numbers[j].data(), chunk.numbers[j].size());
+                        vector<float>().swap(chunk.numbers[j]);
+                    } else {
+                        pDataSource->addStringColumnValues(j, chunk.levels[j], chunk.codes[j].data(), chunk.codes[j].size());
+                        vector<int>().swap(chunk.codes[j]);
+                        vector<string>().swap(chunk.levels[j]);
+                    }
+                }
+            }
+        } catch(...) {
+            delete pDataSource;
+            throw;
+        }
+        return pDataSource;
+    }
+
+private:
+    enum TYPE {NA, NUMBER, STRING};
+
+    struct Field {
+        const char* begin;
+        const char* end;
+        bool escaped;
+        bool lineEnd;
+    };
+
+    struct Chunk {
+        Chunk(const char* b, const char* e): begin(b), end(e) {
+        }
+        const char* begin;
+        const char* end;
+        vector<char> types;
+        vector<vector<float> > numbers;
+        vector<vector<int> > codes;
+        vector<vector<string> > levels;
+    };
+
+    // Split at line ends outside of quotes into chunks of about cCsvChunkSize bytes
+    void split(const char* p, const char* end, vector<Chunk>& chunks) const {
+        size_t size = end - p;
+        size_t chunkSize = max(min(cCsvChunkSize, size / (4 * _parallelFor.getNumberOfThreads()) + 1), (size_t)65536);
+        bool quotes = memchr(p, '"', size) != 0;
+        bool inQuotes = false;
+        const char* q = p;
+        while(p < end) {
+            const char* target = p + min(chunkSize, (size_t)(end - p));
+            if(quotes) {
+                for(; q < target; q++) {
+                    inQuotes ^= *q == '"';
+                }
+                for(; q < end && (inQuotes || *q != '\n'); q++) {
+                    inQuotes ^= *q == '"';
+                }
+            } else {
+                q = (const char*)memchr(target, '\n', end - target);
+                if(q == 0) {
+                    q = end;
+                }
+            }
+            q = min(q + 1, end);
+            chunks.push_back(Chunk(p, q));
+            p = q;
+        }
+    }
+
+    // A field is read into one column only, so column names have to be unique
+    static void checkUniqueNames(const vector<string>& names) {
+        unordered_map<string, int> counts;
+        for(int i = 0; i < (int)names.size(); i++) {
+            if(++counts[names[i]] > 1) {
+                throw string(cCsvDuplicateColumn + " " + names[i]);
+            }
+        }
+    }
+
+    const char* skipEmptyLines(const char* p, const char* end) const {
+        while(p < end && (*p == '\n' || (*p == '\r' && p + 1 < end && p[1] == '\n'))) {
+            p++;
+        }
+        return p;
+    }
+
+    // Parse the field starting at p and return the position after its separator or line end
+    const char* readField(const char* p, const char* end, Field& field) const {
+        field.escaped = false;
+        if(p < end && *p == '"') {
+            field.begin = ++p;
+            while(true) {
+                const char* q = (const char*)memchr(p, '"', end - p);
+                if(q == 0) {
+                    field.end = end;
+                    p = end;
+                    break;
+                }
+                if(q + 1 < end && q[1] == '"') {
+                    field.escaped = true;
+                    p = q + 2;
+                } else {
+                    field.end = q;
+                    p = q + 1;
+                    break;
+                }
+            }
+            while(p < end && *p != _separator && *p != '\n') {
+                p++;
+            }
+        } else {
+            field.begin = p;
+            while(p < end && *p != _separator && *p != '\n') {
+                p++;
+            }
+            field.end = p;
+            if(field.end > field.begin && field.end[-1] == '\r') {
+                field.end--;
+            }
+        }
+        field.lineEnd = p == end || *p == '\n';
+        return p < end ? p + 1 : end;
+    }
+
+    const char* readLine(const char* p, const char* end, vector<string>& fields) const {
+        Field field;
+        do {
+            p = readField(p, end, field);
+            fields.push_back(getString(field));
+        } while(!field.lineEnd);
+        return p;
+    }
+
+    // Call f(column, field) for the selected fields of each line of a chunk
+    template<class F> void forEachField(const Chunk& chunk, F f) const {
+        const char* p = chunk.begin;
+        Field field;
+        while((p = skipEmptyLines(p, chunk.end)) < chunk.end) {
+            int i = 0;
+            do {
+                p = readField(p, chunk.end, field);
+                if(i >= _fieldCount) {
+                    throw string(cCsvInvalidFieldCount);
+                }
+                if(_fieldColumn[i] >= 0) {
+                    f(_fieldColumn[i], field);
+                }
+                i++;
+            } while(!field.lineEnd);
+            for(; i < _fieldCount; i++) {
+                if(_fieldColumn[i] >= 0) {
+                    field.begin = field.end = p;
+                    field.escaped = false;
+                    f(_fieldColumn[i], field);
+                }
+            }
+        }
+    }
+
+    void inferTypes(Chunk& chunk) const {
+        chunk.types.assign(_columnCount, NA);
+        float value;
+        forEachField(chunk, [&](int j, const Field& field) {
+            if(chunk.types[j] != STRING && !isNA(field)) {
+                chunk.types[j] = parseFloat(field.begin, field.end, value) ? NUMBER : STRING;
+            }
+        });
+    }
+
+    void parse(Chunk& chunk) const {
+        chunk.numbers.resize(_columnCount);
+        chunk.codes.resize(_columnCount);
+        chunk.levels.resize(_columnCount);
+        vector<unordered_map<string, int> > dictionaries(_columnCount);
+        float value;
+        forEachField(chunk, [&](int j, const Field& field) {
+            if(_numerical[j]) {
+                if(isNA(field) || !parseFloat(field.begin, field.end, value)) {
+                    value = nan("");
+                }
+                chunk.numbers[j].push_back(value);
+            } else if(isNA(field)) {
+                chunk.codes[j].push_back(0);
+            } else {
+                string s = getString(field);
+                unordered_map<string, int>::iterator it = dictionaries[j].find(s);
+                if(it == dictionaries[j].end()) {
+                    chunk.levels[j].push_back(s);
+                    it = dictionaries[j].insert(make_pair(s, (int)chunk.levels[j].size())).first;
+                }
+                chunk.codes[j].push_back(it->second);
+            }
+        });
+    }
+
+    static bool isNA(const Field& field) {
+        const char* b = field.begin;
+        const char* e = field.end;
+        trim(b, e);
+        return b == e || (e - b == 2 && b[0] == 'N' && b[1] == 'A');
+    }
+
+    static void trim(const char*& b, const char*& e) {
+        while(b < e && (*b == ' ' || *b == '\t')) {
+            b++;
+        }
+        while(e > b && (e[-1] == ' ' || e[-1] == '\t')) {
+            e--;
+        }
+    }
+
+    static string getString(const Field& field) {
+        if(!field.escaped) {
+            return string(field.begin, field.end);
+        }
+        string s;
+        for(const char* p = field.begin; p < field.end; p++) {
+            s.push_back(*p);
+            if(*p == '"' && p + 1 < field.end && p[1] == '"') {
+                p++;
+            }
+        }
+        return s;
+    }
+
+    static bool parseFloat(const char* b, const char* e, float& value) {
+        trim(b, e);
+        if(b < e && *b == '+') {
+            b++;
+        }
+        if(b == e) {
+            return false;
+        }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        from_chars_result result = from_chars(b, e, value);
+        if(result.ptr != e) {
+            return false;
+        }
+        if(result.ec == errc::result_out_of_range) {
+            value = (float)strtod(string(b, e).c_str(), 0);
+            return true;
+        }
+        return result.ec == errc();
+#else
+        char buffer[64];
+        if(e - b >= (int)sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, b, e - b);
+        buffer[e - b] = 0;
+        char* q;
+        value = strtof(buffer, &q);
+        return q == buffer + (e - b);
+#endif
+    }
+
+    char _separator;
+    ParallelFor _parallelFor;
+    vector<int> _fieldColumn;
+    int _fieldCount;
+    int _columnCount;
+    vector<bool> _numerical;
+};
+
+#endif
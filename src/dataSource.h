@@ -12,6 +12,10 @@
 #include "numberColumn.h"
 #include "stringColumn.h"
 #include "numberArrayColumn.h"
+#include "rowMatrix.h"
+#include "densityIndex.h"
+#include "quantileSketch.h"
+#include "knnGraph.h"
 
 using namespace std;
 
@@ -26,15 +30,34 @@ const string cInvalidTypeSuffix = "is invalid";
 const string cInvalidColumnPrefix = "Type of column";
 
 const string cDataSourceTypeId = "c46afa0e-51b6-4877-b4f4-53d909e34a7d";
-const wstring cDensityColumn = L"Densities";
+const string cDensityColumn = "Densities";
 
 const string cNoDensities = "No density values calculated";
+const string cNoDensitiesForNearestNeighbors = "No density values calculated for number of nearest neighbors";
+
+const int cRowChunkSize = 4096;
+
+// Version 3 adds a checksum at the end of each section, version 4 stores
+// text as UTF-8 instead of wchar_t, version 5 frames vectors in blocks that
+// may be compressed, version 6 adds a quantile sketch of density values,
+// version 7 adds density values for several numbers of nearest neighbors,
+// version 8 adds the graph of nearest neighbors, version 9 adds cluster labels,
+// version 10 adds the nearest neighbor radii of density values
+const int cChecksumVersion = 3;
+const int cUtf8Version = 4;
+const int cBlockVersion = 5;
+const int cSketchVersion = 6;
+const int cDensityVectorsVersion = 7;
+const int cKnnGraphVersion = 8;
+const int cClusterLabelsVersion = 9;
+const int cDensityRadiiVersion = 10;
+const int cDataSourceVersion = 10;
 
 class DataSource{
 public:
-	DataSource():  _typeId(cDataSourceTypeId), _version(1), _normalized(false), _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)) {
+	DataSource():  _typeId(cDataSourceTypeId), _version(1), _normalized(false), _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)), _densityRadiiNearestNeighbors(0) {
 	}
-    DataSource(const DataSource& dataSource): _typeId(cDataSourceTypeId), _version(1), _normalized(false),  _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)) {
+    DataSource(const DataSource& dataSource): _typeId(cDataSourceTypeId), _version(1), _normalized(false),  _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)), _densityRadiiNearestNeighbors(0) {
 	    _version = dataSource._version;
 	    _normalized = false;
 	  
@@ -53,12 +76,12 @@ public:
 	    
 	    buildNormalizedNumberVectorVector();
 	}
-    DataSource(const vector<Column::COLUMN_TYPE>& columnTypes, const std::vector<wstring>& columnNames): _typeId(cDataSourceTypeId), _version(1), _normalized(false), _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)) {
+    DataSource(const vector<Column::COLUMN_TYPE>& columnTypes, const std::vector<string>& columnNames): _typeId(cDataSourceTypeId), _version(1), _normalized(false), _pDensityVector(new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn)), _densityRadiiNearestNeighbors(0) {
         _normalized = false;
         
         for(int i = 0; i < (int)columnTypes.size(); i++) {
             Column::COLUMN_TYPE columnType = columnTypes[i];
-            wstring columnName = columnNames[i];
+            string columnName = columnNames[i];
             if(columnType == Column::STRING) {
                 _columnVector.push_back(new StringColumn(columnType, columnName));
             } else if(columnType == Column::NUMERICAL) {
@@ -72,6 +95,7 @@ public:
 		for(int i = 0; i < (int)_columnVector.size(); i++) {
 			delete _columnVector[i];
 		}
+		clearDensityVectors();
 	}
 
     virtual void clear() {
@@ -79,7 +103,7 @@ public:
             _columnVector[i]->clear();
         }
         
-        _numberVectorVector.clear();
+        _rowMatrix.clear();
     }
     virtual int getDimension() {
         int dimension = 0;
@@ -105,7 +129,7 @@ public:
 				StringColumn* pStringColumnB = dynamic_cast<StringColumn*>(dataSource.getColumnVector()[i]);
 
 				for(int j = 0; j < (int)pStringColumnB->getValueVector().size(); j++) {
-					wstring value = pStringColumnB->getValue(j);
+					string value = pStringColumnB->getValue(j);
 					pStringColumnA->addValue(value, false);
 				}
 			} else if(type == Column::NUMERICAL) {
@@ -130,7 +154,7 @@ public:
                 StringColumn* pStringColumnB = dynamic_cast<StringColumn*>(dataSource.getColumnVector()[i]);
         
                 for(int j = 0; j < (int)indexVector.size(); j++) {
-        	        wstring value = pStringColumnB->getValue(indexVector[j]);
+        	        string value = pStringColumnB->getValue(indexVector[j]);
         	        pStringColumnA->addValue(value, false);
                 }
             } else if(type == Column::NUMERICAL) {
@@ -148,7 +172,7 @@ public:
         return *this;
     }
     
-    void addValueRow(vector<std::wstring> valueVector) {
+    void addValueRow(vector<string> valueVector) {
         for(int i = 0; i < (int)valueVector.size(); i++) {
             Column::COLUMN_TYPE type = _columnVector[i]->getColumnType();
             if(type == Column::STRING) {
@@ -162,14 +186,36 @@ public:
             }
         }
     }
-    float getFloatValue(const wstring& stringValue) {
-        if(stringValue == L"NA") {
+    // Append the values of a whole column, missing values are NaN
+    template<class T> void addNumberColumnValues(int i, const T* p, int size) {
+        if(i < 0 || i > (int)_columnVector.size() - 1) {
+            throw string(cInvalidIndex);
+        }
+        NumberColumn* pNumberColumn = dynamic_cast<NumberColumn*>(_columnVector[i]);
+        if(pNumberColumn == 0) {
+            throw string(cInvalidColumnType);
+        }
+        pNumberColumn->addValues(p, size);
+    }
+    // Append the values of a whole column given as 1-based codes into levels
+    void addStringColumnValues(int i, const vector<string>& levels, const int* codes, int size) {
+        if(i < 0 || i > (int)_columnVector.size() - 1) {
+            throw string(cInvalidIndex);
+        }
+        StringColumn* pStringColumn = dynamic_cast<StringColumn*>(_columnVector[i]);
+        if(pStringColumn == 0) {
+            throw string(cInvalidColumnType);
+        }
+        pStringColumn->addValues(levels, codes, size);
+    }
+    float getFloatValue(const string& stringValue) {
+        if(stringValue == "NA") {
             return nan("");
         }
         
-        wstring sv = stringValue;
+        string sv = stringValue;
         float value;
-        wstringstream wss(sv);
+        stringstream wss(sv);
         wss >> value;
         if(wss.fail()) {
             string invalidType = cInvalidTypePrefix + " ";
@@ -184,7 +230,7 @@ public:
         return value;
     }
 
-	void addColumn(const Column::COLUMN_TYPE& type, const wstring& name) {
+	void addColumn(const Column::COLUMN_TYPE& type, const string& name) {
 		if (type == Column::STRING) {
 			_columnVector.push_back(new StringColumn(type, name));
 		} else if(type == Column::NUMERICAL) {
@@ -192,6 +238,7 @@ public:
 		} else {
 			throw string(cInvalidColumnType);
 		}
+		_columnVector.back()->setPageDirectory(_pageDirectory);
 	}
 	vector<float> getNumberVector(int i) {
 		vector<float> numberVector;
@@ -223,8 +270,8 @@ public:
         }
         return numberVector;
     }
-    vector<wstring> getActiveColumnNames() {
-        vector<wstring> activeColumnNames;
+    vector<string> getActiveColumnNames() {
+        vector<string> activeColumnNames;
         for(auto column : _columnVector) {
             if(column->getActive()) {
                 activeColumnNames.push_back(column->getName());
@@ -232,8 +279,8 @@ public:
         }
         return activeColumnNames;
     }
-    vector<wstring> getInactiveColumnNames() {
-        vector<wstring> inactiveColumnNames;
+    vector<string> getInactiveColumnNames() {
+        vector<string> inactiveColumnNames;
         for(auto column : _columnVector) {
             if(!column->getActive()) {
                 inactiveColumnNames.push_back(column->getName());
@@ -264,7 +311,7 @@ public:
         }
         return i;
     }
-    wstring getNumberVectorIndexName(int numberVectorIndex) {
+    string getNumberVectorIndexName(int numberVectorIndex) {
         int dimension = getDimension();
         if(numberVectorIndex < 0 || numberVectorIndex > dimension - 1) {
             throw string(cInvalidIndex);
@@ -286,18 +333,18 @@ public:
             throw string(cInvalidColumnIndex);
         }
     
-        wstring numberVectorIndexName = _columnVector[i]->getName();
+        string numberVectorIndexName = _columnVector[i]->getName();
         Column::COLUMN_TYPE type = _columnVector[i]->getColumnType();
         /*
         if(type == Column::STRING) {
             StringColumn* pStringColumn = dynamic_cast<StringColumn*>(_columnVector[i]);
             int k = numberVectorIndex - j + 1;
-            map<int, wstring>::const_iterator inverseValueMapIter;
+            map<int, string>::const_iterator inverseValueMapIter;
             inverseValueMapIter = pStringColumn->getInverseValueMap().find(k);
             if(inverseValueMapIter ==  pStringColumn->getInverseValueMap().end()) {
                 throw string(cInvalidIndex);
             }
-            numberVectorIndexName += L".";
+            numberVectorIndexName += ".";
             numberVectorIndexName += inverseValueMapIter->second;
         } else
         */
@@ -306,7 +353,7 @@ public:
         } else if(type == Column::NUMERICAL_ARRAY) {
             NumberArrayColumn* pNumberArrayColumn = dynamic_cast<NumberArrayColumn*>(_columnVector[i]);
             int k = numberVectorIndex - j;
-            numberVectorIndexName += L".";
+            numberVectorIndexName += ".";
             numberVectorIndexName += pNumberArrayColumn->getNumberColumnArray()[k].getName();
         } else {
             throw string(cInvalidColumnType);
@@ -314,16 +361,16 @@ public:
 
         return numberVectorIndexName;
     }
-    vector<wstring> getNumbeVectorIndexNames(vector<int> numberVectorIndices) {
-	    vector<wstring> numberVextorIndexNames;
+    vector<string> getNumbeVectorIndexNames(vector<int> numberVectorIndices) {
+	    vector<string> numberVextorIndexNames;
 	    for(int i = 0; i < (int)numberVectorIndices.size(); i++) {
 		    numberVextorIndexNames.push_back(getNumberVectorIndexName(numberVectorIndices[i]));
 	    }
 
 	    return numberVextorIndexNames;
     }
-    vector<wstring> getColumnNames(vector<int> indexVector) {
-        vector<wstring> columnNames;
+    vector<string> getColumnNames(vector<int> indexVector) {
+        vector<string> columnNames;
         for(int i = 0; i < (int)indexVector.size(); i++) {
             columnNames.push_back(_columnVector[indexVector[i]]->getName());
         }
@@ -373,9 +420,7 @@ public:
         vector<float> numberVector;
 
         vector<int> indexVector(rowCount, 0);
-        for(int i = 0; i < (int)indexVector.size(); i++) {
-            indexVector[i] = _uniformIntDistribution();
-        }
+        _uniformIntDistribution.fill(indexVector.data(), indexVector.size());
           
         for(int i = 0; i < rowCount; i++) {
             vector<float> rowNumberVector = getNumberVector((indexVector)[i]);
@@ -391,10 +436,7 @@ public:
         }
        
         vector<int> indexVector(rowCount, 0);
-        for(int i = 0; i < (int)indexVector.size(); i++) {
-
-            indexVector[i] = _uniformIntDistribution();
-        }
+        _uniformIntDistribution.fill(indexVector.data(), indexVector.size());
     
         for(int i = 0; i < rowCount; i++) {
             vector<float> rowNumberVector = getNormalizedNumberVector((indexVector)[i]);
@@ -409,13 +451,46 @@ public:
         }
       
         vector<int> indexVector(rowCount, 0);
-        for(int i = 0; i < (int)indexVector.size(); i++) {
-            indexVector[i] = _uniformIntDistribution();
-        }
+        _uniformIntDistribution.fill(indexVector.data(), indexVector.size());
         
+        int dimension = _rowMatrix.getDimension();
         for(int i = 0; i < rowCount; i++) {
-            vector<float>& rowNumberVector = getNormalizedNumberVectorReference((indexVector)[i]);
-            numberVector.insert(numberVector.end(), rowNumberVector.begin(), rowNumberVector.end());
+            const float* rowNumberVector = getNormalizedRowData((indexVector)[i]);
+            numberVector.insert(numberVector.end(), rowNumberVector, rowNumberVector + dimension);
+        }
+    }
+
+    // Gather rowCount random normalized rows column-major into p, which
+    // must hold rowCount * getDimension() values
+    void getNormalizedDataRandom(double* p, int rowCount) {
+        if(!_normalized) {
+            throw string(cDataSourceNotNormalized);
+        }
+
+        vector<int> indexVector(rowCount, 0);
+        _uniformIntDistribution.fill(indexVector.data(), indexVector.size());
+
+        for(auto column : _columnVector) {
+            if(column->getActive()) {
+                column->getNormalizedNumberMatrix(indexVector, p, rowCount);
+                p += (size_t)column->getDimension() * rowCount;
+            }
+        }
+    }
+
+    // Gather the normalized rows in indexVector column-major into p, missing
+    // values are imputed from generator on every call
+    void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, Philox& generator) {
+        if(!_normalized) {
+            throw string(cDataSourceNotNormalized);
+        }
+
+        int rowCount = indexVector.size();
+        for(auto column : _columnVector) {
+            if(column->getActive()) {
+                column->getNormalizedNumberMatrix(indexVector, p, rowCount, generator);
+                p += (size_t)column->getDimension() * rowCount;
+            }
         }
     }
 
@@ -436,6 +511,8 @@ public:
     
     void setColumnActive(int i, bool active) {
 	    (_columnVector[i])->setActive(active);
+	    _knnGraph.clear();
+	    clearDensityRadii();
 	}
 	void setColumnsActive(vector<int> indexVector, bool active) {
 		for(int i = 0; i < (int)indexVector.size(); i++) {
@@ -444,9 +521,13 @@ public:
 		    }
 			(_columnVector[indexVector[i]])->setActive(active);
 		}
+		_knnGraph.clear();
+		clearDensityRadii();
 	}
   
-	void write(ofstream& os, int version = 2) {
+	void write(OutStream& os, int version = cDataSourceVersion) {
+	    os.setChecksums(version >= cChecksumVersion);
+	    os.setBlocks(version >= cBlockVersion);
 	    InOut::Write(os, _typeId);
 	  
 		InOut::Write(os, version);
@@ -454,18 +535,52 @@ public:
 
 		int size = _columnVector.size();
 		InOut::Write(os, size);
+		os.endSection();
 		for(int i = 0; i < (int)_columnVector.size(); i++) {
 			int t = static_cast<int>(_columnVector[i]->getColumnType());
 			InOut::Write(os, t);
 			_columnVector[i]->write(os);
+			os.endSection();
 		}
 		
 		int t = static_cast<int>(_pDensityVector->getColumnType());
 		InOut::Write(os, t);
 		_pDensityVector->write(os);
+		os.endSection();
+
+		if(version >= cSketchVersion) {
+		    _densitySketch.write(os);
+		    os.endSection();
+		}
+
+		if(version >= cDensityVectorsVersion) {
+		    int size = _densityVectors.size();
+		    InOut::Write(os, size);
+		    for(int i = 0; i < size; i++) {
+		        InOut::Write(os, _densityNearestNeighbors[i]);
+		        _densityVectors[i]->write(os);
+		    }
+		    os.endSection();
+		}
+
+		if(version >= cKnnGraphVersion) {
+		    _knnGraph.write(os);
+		    os.endSection();
+		}
+
+		if(version >= cClusterLabelsVersion) {
+		    InOut::Write(os, _clusterLabels);
+		    os.endSection();
+		}
+
+		if(version >= cDensityRadiiVersion) {
+		    InOut::Write(os, _densityRadiiNearestNeighbors);
+		    InOut::Write(os, _densityRadii);
+		    os.endSection();
+		}
 	}
  
-	void read(ifstream& is) {
+	void read(InStream& is) {
 	    InOut::Read(is, _typeId);
 	    if(_typeId != cDataSourceTypeId) {
 	        throw string(cInvalidTypeId);
@@ -476,29 +591,32 @@ public:
 	    buildNormalizedNumberVectorVector();
 	    _uniformIntDistribution.setParameters(0, getSize() - 1);
 	}
-    void readWithoutTypeId(ifstream& is) {
+    void readWithoutTypeId(InStream& is) {
         InOut::Read(is, _version);
+        is.setChecksums(_version >= cChecksumVersion);
+        is.setWideStrings(_version < cUtf8Version);
+        is.setBlocks(_version >= cBlockVersion);
         InOut::Read(is, _normalized);
     
-        int size = 0;
-        InOut::Read(is, size);
-        _columnVector.resize(size);
+        int size = InOut::ReadSize(is, sizeof(int));
+        _columnVector.resize(size, 0);
+        is.endSection();
         int t = -1;
         for(int i = 0; i < size; i++) {
             InOut::Read(is, t);
             Column::COLUMN_TYPE type = static_cast<Column::COLUMN_TYPE>(t);
             if(type == Column::STRING) {
                 _columnVector[i] = new StringColumn(type);
-                _columnVector[i]->read(is);
             } else if(type == Column::NUMERICAL) {
                 _columnVector[i] = new NumberColumn(type);
-                _columnVector[i]->read(is);
             } else if(type == Column::NUMERICAL_ARRAY) {
                 _columnVector[i] = new NumberArrayColumn(type, 0);
-                _columnVector[i]->read(is);
             } else {
                 throw string(cInvalidColumnType);
             }
+            _columnVector[i]->setPageDirectory(_pageDirectory);
+            _columnVector[i]->read(is);
+            is.endSection();
         }
         
         InOut::Read(is, t);
@@ -506,7 +624,9 @@ public:
         if(type == Column::NUMERICAL) {
             delete _pDensityVector;
             _pDensityVector = new NumberColumn(Column::NUMERICAL, cDensityColumn);
+            _pDensityVector->setPageDirectory(_pageDirectory);
             _pDensityVector->read(is);
+            is.endSection();
             /*
             if(_version == 1) {
                 Function f("message");
@@ -518,6 +638,43 @@ public:
         } else {
             throw string(cInvalidColumnType);
         }
+        invalidateDensityIndex();
+
+        _densitySketch.clear();
+        if(_version >= cSketchVersion) {
+            _densitySketch.read(is);
+            is.endSection();
+        }
+
+        clearDensityVectors();
+        if(_version >= cDensityVectorsVersion) {
+            int size = InOut::ReadSize(is, sizeof(int));
+            for(int i = 0; i < size; i++) {
+                int nNearestNeighbors = 0;
+                InOut::Read(is, nNearestNeighbors);
+                addDensityVector(nNearestNeighbors)->read(is);
+            }
+            is.endSection();
+        }
+
+        _knnGraph.clear();
+        if(_version >= cKnnGraphVersion) {
+            _knnGraph.read(is);
+            is.endSection();
+        }
+
+        _clusterLabels.clear();
+        if(_version >= cClusterLabelsVersion) {
+            InOut::Read(is, _clusterLabels);
+            is.endSection();
+        }
+
+        clearDensityRadii();
+        if(_version >= cDensityRadiiVersion) {
+            InOut::Read(is, _densityRadiiNearestNeighbors);
+            InOut::Read(is, _densityRadii);
+            is.endSection();
+        }
     }
     
     NumberColumn* getDensityVector() {
@@ -527,15 +684,188 @@ public:
     const NumberColumn* getDensityVector() const {
         return _pDensityVector;
     }
+    // True when density values are calculated for all rows
+    bool hasDensityValues() {
+        int size = _pDensityVector->getNormalizedSize();
+        return size > 0 && size == getNormalizedSize();
+    }
+    // Sorted index of normalized density values, built on first use. Has
+    // to be invalidated when density values change.
+    const DensityIndex& getDensityIndex() {
+        if(!_densityIndex.isBuilt()) {
+            _densityIndex.build(_pDensityVector->getNormalizedValueVector());
+        }
+        return _densityIndex;
+    }
+    void invalidateDensityIndex() {
+        _densityIndex.clear();
+    }
+    // Quantile sketch of normalized density values, built from the density
+    // values on first use if not calculated or read
+    const QuantileSketch& getDensitySketch() {
+        if(_densitySketch.isEmpty()) {
+            const PagedVector<float>& densityVector = _pDensityVector->getNormalizedValueVector();
+            for(int i = 0; i < (int)densityVector.size(); i++) {
+                _densitySketch.update(densityVector[i]);
+            }
+        }
+        return _densitySketch;
+    }
+    void setDensitySketch(const QuantileSketch& densitySketch) {
+        _densitySketch = densitySketch;
+    }
+
+    // Density vectors for several numbers of nearest neighbors in ascending
+    // order. The values of one number are selected into the density vector.
+    const vector<int>& getDensityNearestNeighbors() const {
+        return _densityNearestNeighbors;
+    }
+    NumberColumn* getDensityVector(int nNearestNeighbors) {
+        vector<int>::iterator it = find(_densityNearestNeighbors.begin(), _densityNearestNeighbors.end(), nNearestNeighbors);
+        if(it == _densityNearestNeighbors.end()) {
+            return 0;
+        }
+        return _densityVectors[it - _densityNearestNeighbors.begin()];
+    }
+    // Add an empty density vector for a number of nearest neighbors, an existing one is replaced
+    NumberColumn* addDensityVector(int nNearestNeighbors) {
+        vector<int>::iterator it = lower_bound(_densityNearestNeighbors.begin(), _densityNearestNeighbors.end(), nNearestNeighbors);
+        int i = it - _densityNearestNeighbors.begin();
+        NumberColumn* pDensityVector = new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC, cDensityColumn + " " + to_string(nNearestNeighbors));
+        pDensityVector->setPageDirectory(_pageDirectory);
+        if(it != _densityNearestNeighbors.end() && *it == nNearestNeighbors) {
+            delete _densityVectors[i];
+            _densityVectors[i] = pDensityVector;
+        } else {
+            _densityNearestNeighbors.insert(it, nNearestNeighbors);
+            _densityVectors.insert(_densityVectors.begin() + i, pDensityVector);
+        }
+        return pDensityVector;
+    }
+    void clearDensityVectors() {
+        for(int i = 0; i < (int)_densityVectors.size(); i++) {
+            delete _densityVectors[i];
+        }
+        _densityVectors.clear();
+        _densityNearestNeighbors.clear();
+    }
+    // Copy the density values for a number of nearest neighbors into the
+    // density vector. Values calculated for other rows than the current ones
+    // are not selected. Nearest neighbor radii of another number are cleared.
+    void selectDensityVector(int nNearestNeighbors) {
+        NumberColumn* pDensityVector = getDensityVector(nNearestNeighbors);
+        if(pDensityVector == 0 || pDensityVector->getNormalizedSize() != getNormalizedSize()) {
+            throw string(cNoDensitiesForNearestNeighbors);
+        }
+        _pDensityVector->setMin(pDensityVector->getMin());
+        _pDensityVector->setMax(pDensityVector->getMax());
+        _pDensityVector->getValueVector() = pDensityVector->getValueVector();
+        _pDensityVector->getNormalizedValueVector() = pDensityVector->getNormalizedValueVector();
+        invalidateDensityIndex();
+        _densitySketch.clear();
+        if(_densityRadiiNearestNeighbors != nNearestNeighbors) {
+            clearDensityRadii();
+        }
+    }
+
+    // Distances to the k-th nearest neighbor of the rows for exact density
+    // values of the density vector calculated for k nearest neighbors.
+    // Incremental updates derive the values from them, so they are cleared
+    // when the density values are approximated or selected for another k.
+    const vector<float>& getDensityRadii() const {
+        return _densityRadii;
+    }
+    void setDensityRadii(int nNearestNeighbors, const vector<float>& densityRadii) {
+        _densityRadiiNearestNeighbors = nNearestNeighbors;
+        _densityRadii = densityRadii;
+    }
+    void clearDensityRadii() {
+        _densityRadiiNearestNeighbors = 0;
+        vector<float>().swap(_densityRadii);
+    }
+    // True when radii for nNearestNeighbors are kept for all density values
+    bool hasDensityRadii(int nNearestNeighbors) {
+        return _densityRadiiNearestNeighbors == nNearestNeighbors && !_densityRadii.empty() &&
+            (int)_densityRadii.size() == _pDensityVector->getNormalizedSize();
+    }
+
+    // Graph of nearest neighbors of the normalized rows, empty if not calculated
+    KnnGraph& getKnnGraph() {
+        return _knnGraph;
+    }
+    // True when the graph holds nNearestNeighbors neighbors for all rows
+    bool hasKnnGraph(int nNearestNeighbors) {
+        return !_knnGraph.isEmpty() && _knnGraph.getK() >= nNearestNeighbors &&
+            _knnGraph.getSize() == getNormalizedSize() && _knnGraph.getDimension() == getDimension();
+    }
+
+    // Cluster labels of rows, 0 for noise
+    vector<int>& getClusterLabels() {
+        return _clusterLabels;
+    }
+    // True when cluster labels are calculated for all rows
+    bool hasClusterLabels() {
+        return !_clusterLabels.empty() && (int)_clusterLabels.size() == getNormalizedSize();
+    }
     
+    // Build the normalized row cache in chunks of cRowChunkSize rows, only
+    // one chunk is held column-major at a time
     void buildNormalizedNumberVectorVector() {
-        _numberVectorVector.resize(getNormalizedSize());
-        for(int i = 0; i < getNormalizedSize(); i++) {
-            _numberVectorVector[i] = getNormalizedNumberVector(i);
+        int size = getNormalizedSize();
+        int dimension = getDimension();
+        _rowMatrix.resize(size, dimension);
+
+        vector<int> indexVector;
+        vector<double> chunk;
+        for(int begin = 0; begin < size; begin += cRowChunkSize) {
+            int rowCount = min(cRowChunkSize, size - begin);
+            indexVector.resize(rowCount);
+            for(int i = 0; i < rowCount; i++) {
+                indexVector[i] = begin + i;
+            }
+            chunk.resize((size_t)rowCount * dimension);
+            double* p = chunk.data();
+            for(auto column : _columnVector) {
+                if(column->getActive()) {
+                    column->getNormalizedNumberMatrix(indexVector, p, rowCount);
+                    p += (size_t)column->getDimension() * rowCount;
+                }
+            }
+            for(int i = 0; i < rowCount; i++) {
+                float* row = _rowMatrix[begin + i];
+                for(int j = 0; j < dimension; j++) {
+                    row[j] = chunk[(size_t)j * rowCount + i];
+                }
+            }
+        }
+    }
+    // Row i of the normalized row cache, getDimension() values
+    const float* getNormalizedRowData(int i) const {
+        return _rowMatrix[i];
+    }
+    // Keep the values of the columns, the density values and the normalized
+    // row cache in page files of pageDirectory instead of memory, empty for
+    // memory. Present values are moved and the cache is rebuilt if rows are
+    // present, columns read or added later keep their values in the page
+    // directory. Reading, normalization, sampling and density calculations
+    // access the values through the mapped page files, so only the pages in
+    // use are resident.
+    void setPageDirectory(const string& pageDirectory) {
+        _pageDirectory = pageDirectory;
+        for(auto column : _columnVector) {
+            column->setPageDirectory(pageDirectory);
+        }
+        _pDensityVector->setPageDirectory(pageDirectory);
+        for(auto pDensityVector : _densityVectors) {
+            pDensityVector->setPageDirectory(pageDirectory);
+        }
+        _rowMatrix.setPageDirectory(pageDirectory);
+        if(getNormalizedSize() > 0) {
+            buildNormalizedNumberVectorVector();
         }
     }
-    vector<float>& getNormalizedNumberVectorReference(int i) {
-        return _numberVectorVector[i];
+    bool isPaged() const {
+        return _rowMatrix.isPaged();
     }
     
 protected:
@@ -546,7 +876,16 @@ protected:
     vector<Column*> _columnVector;
 	
 	NumberColumn* _pDensityVector;
-	vector<vector<float>> _numberVectorVector;
+	string _pageDirectory;
+	RowMatrix _rowMatrix;
+	DensityIndex _densityIndex;
+	QuantileSketch _densitySketch;
+	vector<int> _densityNearestNeighbors;
+	vector<NumberColumn*> _densityVectors;
+	KnnGraph _knnGraph;
+	vector<int> _clusterLabels;
+	int _densityRadiiNearestNeighbors;
+	vector<float> _densityRadii;
 	
 	UniformIntDistribution _uniformIntDistribution;
 };
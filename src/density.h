@@ -10,43 +10,385 @@
 #include "dataSource.h"
 #include "vpTree.h"
 #include "normalizeData.h"
+#include "parallel.h"
 
 const string cInvalidDensiyValue = "Invalid density value inf";
 
+const int cDensityBlockSize = 256;
+const double cDensityRadiusTolerance = 1e-4;
+const int cDensityHoldoutSize = 100;
+const uint64_t cApproximateDensityTask = 1;
+
+const string cInvalidSampleSize = "Invalid sample size";
+const string cInvalidNearestNeighbors = "Invalid number of nearest neighbors";
+
+// Errors of approximate density values against exact values on holdout rows
+struct DensityErrors {
+    DensityErrors(): holdoutSize(0), zeroExactValues(0), meanRelativeError(0), medianRelativeError(0), maxRelativeError(0), meanNormalizedError(0) {}
+
+    int holdoutSize;
+    int zeroExactValues;
+    float meanRelativeError;
+    float medianRelativeError;
+    float maxRelativeError;
+    float meanNormalizedError;
+};
+
 class Density{
 public:
     Density(DataSource& dataSource, VpTree* vpTree, int nNearestNeighbors, Progress* pProgress) : _dataSource(dataSource), _vpTree(vpTree), _nNearestNeighbors(nNearestNeighbors), _pProgress(pProgress) {}
 
+    // Density values of all rows. The nearest neighbors are taken from the
+    // graph of the data source if it holds enough neighbors for all rows,
+    // otherwise they are searched in the tree. The k-th nearest neighbor
+    // radii are kept in the data source for updates. Density vectors of
+    // several numbers of nearest neighbors are cleared.
     void calculateDensityValues() {
-        vector<float>& densityVector = _dataSource.getDensityVector()->getValueVector();
+        _dataSource.clearDensityVectors();
+        PagedVector<float>& densityVector = _dataSource.getDensityVector()->getValueVector();
         densityVector.resize(_dataSource.getNormalizedSize(), 0);
+        vector<float> radii(densityVector.size(), 0);
+        bool knnGraph = _dataSource.hasKnnGraph(_nNearestNeighbors);
 
+        QuantileSketch densitySketch;
+        vector<VpElement> nearestNeighbors;
         for(int i = 0; i < (int)densityVector.size(); i++) {
             if(_pProgress != 0) {
                 (*_pProgress)(i);
             }
 
-            vector<float>& numberVector = _dataSource.getNormalizedNumberVectorReference(i);
-            vector<VpElement> nearestNeighbors;
-            _vpTree->search(numberVector, _nNearestNeighbors, nearestNeighbors);
+            getNearestNeighbors(i, _nNearestNeighbors, knnGraph, nearestNeighbors);
 
             //float d = calculateDensityValue(nearestNeighbors);
             float d = calculateKNearestNeighborDensityEstimation(nearestNeighbors, densityVector.size(), _dataSource.getDimension());
             densityVector[i] = d;
+            if(!nearestNeighbors.empty()) {
+                radii[i] = nearestNeighbors.back().getDistance();
+            }
 
             if(isinf(d)) {
                 throw string(cInvalidDensiyValue);
             }
+            densitySketch.update(d);
         }
 
-        NormalizeData normalizeData;
-        normalizeData.normalize(_dataSource.getDensityVector(), true);
-        _dataSource.getDensityVector()->getValueVector().clear();
+        normalizeDensityValues(densitySketch);
+        _dataSource.setDensityRadii(_nNearestNeighbors, radii);
 
         if(_pProgress != 0) {
             (*_pProgress)(_dataSource.getNormalizedSize());
         }
     }
+
+    // Density values for several numbers of nearest neighbors from a single
+    // search per row for the largest number, as the nearest neighbors for a
+    // smaller number are a prefix of these. The values for each number are
+    // kept in a density vector of the data source, the values for the first
+    // number are selected together with their nearest neighbor radii and their
+    // quantile sketch, which is built per block and merged.
+    void calculateDensityValues(const vector<int>& nNearestNeighbors, int numberOfThreads = 0) {
+        if(nNearestNeighbors.empty()) {
+            throw string(cInvalidNearestNeighbors);
+        }
+        for(int k : nNearestNeighbors) {
+            if(k <= 0) {
+                throw string(cInvalidNearestNeighbors);
+            }
+        }
+
+        int n = _dataSource.getNormalizedSize();
+        int dimension = _dataSource.getDimension();
+        int maxNearestNeighbors = *max_element(nNearestNeighbors.begin(), nNearestNeighbors.end());
+        _dataSource.clearDensityVectors();
+        for(int k : nNearestNeighbors) {
+            _dataSource.addDensityVector(k)->getValueVector().resize(n, 0);
+        }
+        const vector<int>& densityNearestNeighbors = _dataSource.getDensityNearestNeighbors();
+        bool knnGraph = _dataSource.hasKnnGraph(maxNearestNeighbors);
+        vector<PagedVector<float>*> densityVectors;
+        for(int k : densityNearestNeighbors) {
+            densityVectors.push_back(&_dataSource.getDensityVector(k)->getValueVector());
+        }
+        vector<float> radii(n, 0);
+        int selected = find(densityNearestNeighbors.begin(), densityNearestNeighbors.end(), nNearestNeighbors[0]) - densityNearestNeighbors.begin();
+        BlockQuantileSketch blockSketch;
+
+        ParallelFor parallelFor(numberOfThreads);
+        parallelFor((n + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            QuantileSketch densitySketch;
+            vector<VpElement> nearestNeighbors;
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                getNearestNeighbors(i, maxNearestNeighbors, knnGraph, nearestNeighbors);
+                for(int j = 0; j < (int)densityNearestNeighbors.size(); j++) {
+                    float d = calculateKNearestNeighborDensityEstimation(nearestNeighbors, densityNearestNeighbors[j], n, dimension);
+                    if(isinf(d)) {
+                        throw string(cInvalidDensiyValue);
+                    }
+                    (*densityVectors[j])[i] = d;
+                }
+                densitySketch.update((*densityVectors[selected])[i]);
+                int count = min(nNearestNeighbors[0], (int)nearestNeighbors.size());
+                if(count > 0) {
+                    radii[i] = nearestNeighbors[count - 1].getDistance();
+                }
+            }
+            blockSketch.add(b, densitySketch);
+        });
+
+        NormalizeData normalizeData;
+        for(int k : densityNearestNeighbors) {
+            normalizeData.normalize(_dataSource.getDensityVector(k), true);
+        }
+        _dataSource.selectDensityVector(nNearestNeighbors[0]);
+        normalizeDensityValues(blockSketch.getQuantileSketch());
+        for(int k : densityNearestNeighbors) {
+            _dataSource.getDensityVector(k)->getValueVector().clear();
+        }
+        _dataSource.setDensityRadii(nNearestNeighbors[0], radii);
+
+        if(_pProgress != 0) {
+            (*_pProgress)(n);
+        }
+    }
+
+    // Calculate the graph of the nearest neighbors of all rows with searches
+    // in the tree on numberOfThreads threads and keep it in the data source.
+    // Later density calculations for the same or a smaller number of nearest
+    // neighbors take the neighbors from the graph without searches.
+    void calculateKnnGraph(int numberOfThreads = 0) {
+        calculateKnnGraph(_dataSource.getKnnGraph(), numberOfThreads);
+    }
+    // Calculate the graph of the nearest neighbors of all rows into knnGraph
+    void calculateKnnGraph(KnnGraph& knnGraph, int numberOfThreads = 0) {
+        int n = _dataSource.getNormalizedSize();
+        knnGraph.clear();
+        knnGraph.resize(n, _nNearestNeighbors, min(_nNearestNeighbors, n), _dataSource.getDimension());
+
+        ParallelFor parallelFor(numberOfThreads);
+        parallelFor((n + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            vector<VpElement> nearestNeighbors;
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                _vpTree->search(_dataSource.getNormalizedRowData(i), _nNearestNeighbors, nearestNeighbors);
+                int* indices = knnGraph.getIndices(i);
+                float* distances = knnGraph.getDistances(i);
+                for(int j = 0; j < knnGraph.getNeighborCount(i); j++) {
+                    indices[j] = nearestNeighbors[j].getIndex();
+                    distances[j] = nearestNeighbors[j].getDistance();
+                }
+            }
+        });
+
+        if(_pProgress != 0) {
+            (*_pProgress)(n);
+        }
+    }
+
+    // Update density values after rows were appended to rows with density
+    // values. The k-th nearest neighbor radius of a previous row only changes
+    // when an appended row lies within it, these rows are found with reverse
+    // range searches and searched again together with the appended rows. The
+    // values of all other rows are calculated from their radii with the new
+    // number of rows. Without radii of the previous rows for the number of
+    // nearest neighbors, e.g. for approximate values or values selected for
+    // another number, all values are calculated. Density vectors of several
+    // numbers of nearest neighbors no longer match the rows and are cleared.
+    // The tree has to contain all rows.
+    void updateDensityValues(int numberOfThreads = 0) {
+        int m = _dataSource.getDensityVector()->getNormalizedSize();
+        int n = _dataSource.getNormalizedSize();
+        if(!_dataSource.hasDensityRadii(_nNearestNeighbors) || m <= _nNearestNeighbors || m > n) {
+            calculateDensityValues();
+            return;
+        }
+        if(m == n) {
+            return;
+        }
+        _dataSource.clearDensityVectors();
+
+        int dimension = _dataSource.getDimension();
+        vector<float> densityRadii = _dataSource.getDensityRadii();
+        densityRadii.resize(n, 0);
+        vector<float> radii(n, -1);
+        vector<char> update(n, 1);
+        for(int i = 0; i < m; i++) {
+            if(densityRadii[i] > 0 && isfinite(densityRadii[i])) {
+                radii[i] = densityRadii[i] * (1 + cDensityRadiusTolerance);
+                update[i] = 0;
+            }
+        }
+
+        ParallelFor parallelFor(numberOfThreads);
+        vector<float> subtreeRadii;
+        _vpTree->getSubtreeRadii(radii, subtreeRadii);
+        int blockCount = (n - m + cDensityBlockSize - 1) / cDensityBlockSize;
+        vector<vector<int> > blockIndices(blockCount);
+        parallelFor(blockCount, [&](int b) {
+            vector<int> indices;
+            int end = min(n, m + (b + 1) * cDensityBlockSize);
+            for(int i = m + b * cDensityBlockSize; i < end; i++) {
+                _vpTree->reverseRangeSearch(_dataSource.getNormalizedRowData(i), radii, subtreeRadii, indices);
+                blockIndices[b].insert(blockIndices[b].end(), indices.begin(), indices.end());
+            }
+        });
+        for(int b = 0; b < blockCount; b++) {
+            for(int i : blockIndices[b]) {
+                update[i] = 1;
+            }
+        }
+
+        vector<int> rows;
+        for(int i = 0; i < n; i++) {
+            if(update[i]) {
+                rows.push_back(i);
+            }
+        }
+        parallelFor((rows.size() + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            vector<VpElement> nearestNeighbors;
+            int end = min((int)rows.size(), (b + 1) * cDensityBlockSize);
+            for(int j = b * cDensityBlockSize; j < end; j++) {
+                _vpTree->search(_dataSource.getNormalizedRowData(rows[j]), _nNearestNeighbors, nearestNeighbors);
+                densityRadii[rows[j]] = nearestNeighbors.back().getDistance();
+            }
+        });
+
+        PagedVector<float>& densityVector = _dataSource.getDensityVector()->getValueVector();
+        densityVector.resize(n);
+        BlockQuantileSketch blockSketch;
+        parallelFor((n + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            QuantileSketch densitySketch;
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                float d = calculateKNearestNeighborDensityEstimation(densityRadii[i], _nNearestNeighbors, n, dimension);
+                if(isinf(d)) {
+                    throw string(cInvalidDensiyValue);
+                }
+                densityVector[i] = d;
+                densitySketch.update(d);
+            }
+            blockSketch.add(b, densitySketch);
+        });
+
+        normalizeDensityValues(blockSketch.getQuantileSketch());
+        _dataSource.setDensityRadii(_nNearestNeighbors, densityRadii);
+
+        if(_pProgress != 0) {
+            (*_pProgress)(n);
+        }
+    }
+
+    // Approximate density values from the k nearest neighbors among a random
+    // reference sample of sampleSize rows, the estimation uses the sample size
+    // as number of rows. As in the exact calculation a row is counted as its
+    // own nearest neighbor: a sample row finds itself in the reference tree,
+    // for other rows the radius is the distance to the (k - 1)-th nearest
+    // reference row. The reference tree is built on the sample only, so the
+    // time is about linear in the number of rows. Exact values of holdoutSize
+    // random rows, sample rows included, are calculated with linear searches
+    // to report the errors of the approximation. Holdout rows whose
+    // exact value is zero or infinite, e.g. when the volume of the neighbor
+    // ball overflows, have no relative error. They are counted separately and
+    // left out of the relative and normalized errors. Sample and holdout rows
+    // are drawn from a task stream, so they only depend on the seed.
+    DensityErrors calculateApproximateDensityValues(int sampleSize, int holdoutSize = cDensityHoldoutSize, int numberOfThreads = 0) {
+        if(sampleSize <= 0) {
+            throw string(cInvalidSampleSize);
+        }
+        int n = _dataSource.getNormalizedSize();
+        int dimension = _dataSource.getDimension();
+        Philox generator = Rng::TaskStream(cApproximateDensityTask);
+        RandomIndicesWithoutReplacement randomIndicesWithoutReplacement;
+        vector<int> referenceIndices = randomIndicesWithoutReplacement.select(n, sampleSize, generator);
+        int s = referenceIndices.size();
+
+        VpSubsetData vpSubsetData(_dataSource, referenceIndices);
+        L2Distance l2Distance;
+        VpTree referenceTree;
+        referenceTree.build(&vpSubsetData, &l2Distance, 0);
+
+        vector<char> sample(n, 0);
+        for(int j = 0; j < s; j++) {
+            sample[referenceIndices[j]] = 1;
+        }
+
+        PagedVector<float>& densityVector = _dataSource.getDensityVector()->getValueVector();
+        densityVector.assign(n, 0);
+        BlockQuantileSketch blockSketch;
+        ParallelFor parallelFor(numberOfThreads);
+        parallelFor((n + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            QuantileSketch densitySketch;
+            vector<VpElement> nearestNeighbors;
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                int k = sample[i] ? _nNearestNeighbors : _nNearestNeighbors - 1;
+                float radius = 0;
+                if(k > 0) {
+                    referenceTree.search(_dataSource.getNormalizedRowData(i), k, nearestNeighbors);
+                    radius = nearestNeighbors.back().getDistance();
+                }
+                float d = calculateKNearestNeighborDensityEstimation(radius, _nNearestNeighbors, s, dimension);
+                if(isinf(d)) {
+                    throw string(cInvalidDensiyValue);
+                }
+                densityVector[i] = d;
+                densitySketch.update(d);
+            }
+            blockSketch.add(b, densitySketch);
+        });
+
+        vector<int> holdoutIndices = randomIndicesWithoutReplacement.select(n, holdoutSize, generator);
+        int h = holdoutIndices.size();
+        vector<float> exactDensityValues(h);
+        VpGenerativeData vpGenerativeData(_dataSource);
+        VpTree vpTree(&vpGenerativeData, &l2Distance, 0);
+        parallelFor(h, [&](int j) {
+            vector<VpElement> nearestNeighbors;
+            vpTree.linearSearch(_dataSource.getNormalizedRowData(holdoutIndices[j]), _nNearestNeighbors, nearestNeighbors);
+            exactDensityValues[j] = calculateKNearestNeighborDensityEstimation(nearestNeighbors, n, dimension);
+        });
+        vector<float> approximateDensityValues(h);
+        for(int j = 0; j < h; j++) {
+            approximateDensityValues[j] = densityVector[holdoutIndices[j]];
+        }
+
+        normalizeDensityValues(blockSketch.getQuantileSketch());
+        _dataSource.clearDensityRadii();
+
+        DensityErrors densityErrors;
+        densityErrors.holdoutSize = h;
+        NormalizeData normalizeData;
+        NumberColumn* pDensityVector = _dataSource.getDensityVector();
+        vector<float> relativeErrors;
+        relativeErrors.reserve(h);
+        double sumRelativeErrors = 0;
+        double sumNormalizedErrors = 0;
+        for(int j = 0; j < h; j++) {
+            if(!(exactDensityValues[j] > 0) || isinf(exactDensityValues[j])) {
+                densityErrors.zeroExactValues++;
+                continue;
+            }
+            int i = holdoutIndices[j];
+            relativeErrors.push_back(fabs(approximateDensityValues[j] - exactDensityValues[j]) / exactDensityValues[j]);
+            sumRelativeErrors += relativeErrors.back();
+            float exactNormalized = normalizeData.getNormalizedNumber(pDensityVector, exactDensityValues[j], true);
+            sumNormalizedErrors += fabs(pDensityVector->getNormalizedValueVector()[i] - exactNormalized);
+        }
+        int e = relativeErrors.size();
+        if(e > 0) {
+            densityErrors.meanRelativeError = sumRelativeErrors / e;
+            densityErrors.meanNormalizedError = sumNormalizedErrors / e;
+            densityErrors.maxRelativeError = *max_element(relativeErrors.begin(), relativeErrors.end());
+            nth_element(relativeErrors.begin(), relativeErrors.begin() + e / 2, relativeErrors.end());
+            densityErrors.medianRelativeError = relativeErrors[e / 2];
+        }
+
+        if(_pProgress != 0) {
+            (*_pProgress)(n);
+        }
+        return densityErrors;
+    }
+
     /*
     float calculateDensityValue(vector<VpElement> nearestNeighbors) {
         float d = 0;
@@ -61,16 +403,24 @@ public:
         return powf(M_PI, (float)dimension / 2) / tgammaf((float)dimension / 2 + 1);
     }
 
-    float calculateKNearestNeighborDensityEstimation(vector<VpElement> nearestNeighbors, long n, int dimension) {
-        //float c = (float)nearestNeighbors.size() / (float)n * tgammaf((float)dimension / 2 + 1) / powf(M_PI, (float)dimension / 2);
-        float c = (float)nearestNeighbors.size() / (float)n / calculateUnitSphereVolume(dimension);
-
+    float calculateKNearestNeighborDensityEstimation(const vector<VpElement>& nearestNeighbors, long n, int dimension) {
+        return calculateKNearestNeighborDensityEstimation(nearestNeighbors, nearestNeighbors.size(), n, dimension);
+    }
+    // Estimation from the first k of the nearest neighbors
+    float calculateKNearestNeighborDensityEstimation(const vector<VpElement>& nearestNeighbors, int k, long n, int dimension) {
+        k = min(k, (int)nearestNeighbors.size());
         float knnDensityEstimation = 0;
-        if(nearestNeighbors.size() > 0) {
-            knnDensityEstimation = c / powf(nearestNeighbors[nearestNeighbors.size() - 1].getDistance(), (float) dimension);
+        if(k > 0) {
+            knnDensityEstimation = calculateKNearestNeighborDensityEstimation(nearestNeighbors[k - 1].getDistance(), k, n, dimension);
         }
         return knnDensityEstimation;
     }
+    // Estimation from the distance radius to the k-th nearest neighbor
+    float calculateKNearestNeighborDensityEstimation(float radius, int k, long n, int dimension) {
+        //float c = (float)k / (float)n * tgammaf((float)dimension / 2 + 1) / powf(M_PI, (float)dimension / 2);
+        float c = (float)k / (float)n / calculateUnitSphereVolume(dimension);
+        return c / powf(radius, (float) dimension);
+    }
 
     float calculateDensityValue(vector<float>& numberVector) {
         NormalizeData normalizeData;
@@ -82,48 +432,120 @@ public:
             _vpTree->linearSearch(normalizedNumberVector, _nNearestNeighbors, nearestNeighbors);
         }
         //float d = calculateDensityValue(nearestNeighbours);
-        vector<float>& densityVector = _dataSource.getDensityVector()->getNormalizedValueVector();
+        PagedVector<float>& densityVector = _dataSource.getDensityVector()->getNormalizedValueVector();
         float d = calculateKNearestNeighborDensityEstimation(nearestNeighbors, densityVector.size(), _dataSource.getDimension());
         d = normalizeData.getNormalizedNumber(_dataSource.getDensityVector(), d, true);
 
         return d;
     }
 
-    float calculateQuantile(float percent) {
-        vector<float>& densityVector = _dataSource.getDensityVector()->getNormalizedValueVector();
-        vector<float> dV;
-        dV.reserve(densityVector.size());
-        dV.insert(dV.end(), densityVector.begin(), densityVector.end());
-        //int n = (int)ceil(percent / (float)100 * (float)dV.size());
-        int n = (int)floor(percent / (float)100 * (float)dV.size()) - 1;
-        if(n < 0) {
-            n = 0;
-        }
-        if(n >= (int)dV.size()) {
-            n = dV.size() - 1;
+    // Normalized density values of rowCount unnormalized records given
+    // column-major in p. Records are normalized in bulk and searched in
+    // blocks on numberOfThreads threads, the tree must not change meanwhile.
+    vector<float> calculateDensityValues(const double* p, int rowCount, int numberOfThreads = 0) {
+        int dimension = _dataSource.getDimension();
+        vector<float> normalizedRows((size_t)rowCount * dimension);
+        NormalizeData normalizeData;
+        normalizeData.getNormalizedNumberMatrix(_dataSource, p, rowCount, dimension, normalizedRows.data());
+
+        bool built = _vpTree->isBuilt();
+        long n = _dataSource.getDensityVector()->getNormalizedValueVector().size();
+        vector<float> densityValues(rowCount);
+        ParallelFor parallelFor(numberOfThreads);
+        parallelFor((rowCount + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            vector<VpElement> nearestNeighbors;
+            int end = min(rowCount, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                const float* numberVector = normalizedRows.data() + (size_t)i * dimension;
+                if(built) {
+                    _vpTree->search(numberVector, _nNearestNeighbors, nearestNeighbors);
+                } else {
+                    _vpTree->linearSearch(numberVector, _nNearestNeighbors, nearestNeighbors);
+                }
+                densityValues[i] = calculateKNearestNeighborDensityEstimation(nearestNeighbors, n, dimension);
+            }
+        });
+
+        NumberColumn* pDensityVector = _dataSource.getDensityVector();
+        for(int i = 0; i < rowCount; i++) {
+            densityValues[i] = normalizeData.getNormalizedNumber(pDensityVector, densityValues[i], true);
         }
-        nth_element(dV.begin(), dV.begin() + n, dV.end());
+        return densityValues;
+    }
 
-        return dV[n];
+    float calculateQuantile(float percent) {
+        return _dataSource.getDensityIndex().getQuantile(percent);
     }
 
     float calculateInverseQuantile(float densityValue) {
-        vector<float>& densityVector = _dataSource.getDensityVector()->getNormalizedValueVector();
-        if(densityVector.size() == 0) {
-            return 0;
-        }
+        return _dataSource.getDensityIndex().getInverseQuantile(densityValue);
+    }
 
-        float k = 0;
-        for(int i = 0; i < (int)densityVector.size(); i++) {
-            if(densityVector[i] <= densityValue) {
-                k++;
+    // Quantiles from the sorted index or, when approximate, from the quantile sketch
+    vector<float> calculateQuantiles(const vector<float>& percents, bool approximate = false) {
+        vector<float> quantiles(percents.size());
+        if(approximate) {
+            const QuantileSketch& densitySketch = _dataSource.getDensitySketch();
+            for(int i = 0; i < (int)percents.size(); i++) {
+                quantiles[i] = densitySketch.getQuantile(percents[i]);
+            }
+        } else {
+            const DensityIndex& densityIndex = _dataSource.getDensityIndex();
+            for(int i = 0; i < (int)percents.size(); i++) {
+                quantiles[i] = densityIndex.getQuantile(percents[i]);
             }
         }
+        return quantiles;
+    }
 
-        return (float)k / (float)densityVector.size() * 100;
+    vector<float> calculateInverseQuantiles(const vector<float>& densityValues, bool approximate = false) {
+        vector<float> percents(densityValues.size());
+        if(approximate) {
+            const QuantileSketch& densitySketch = _dataSource.getDensitySketch();
+            for(int i = 0; i < (int)densityValues.size(); i++) {
+                percents[i] = densitySketch.getInverseQuantile(densityValues[i]);
+            }
+        } else {
+            const DensityIndex& densityIndex = _dataSource.getDensityIndex();
+            for(int i = 0; i < (int)densityValues.size(); i++) {
+                percents[i] = densityIndex.getInverseQuantile(densityValues[i]);
+            }
+        }
+        return percents;
     }
 
 private:
+    // The k nearest neighbors of row i from the graph or a search in the tree
+    void getNearestNeighbors(int i, int k, bool knnGraph, vector<VpElement>& nearestNeighbors) const {
+        if(!knnGraph) {
+            _vpTree->search(_dataSource.getNormalizedRowData(i), k, nearestNeighbors);
+            return;
+        }
+        const KnnGraph& graph = _dataSource.getKnnGraph();
+        const int* indices = graph.getIndices(i);
+        const float* distances = graph.getDistances(i);
+        int count = min(k, graph.getNeighborCount(i));
+        nearestNeighbors.clear();
+        for(int j = 0; j < count; j++) {
+            nearestNeighbors.push_back(VpElement(indices[j], distances[j]));
+        }
+    }
+
+    // Normalize density values and the quantile sketch of the unnormalized
+    // values built during the calculation, unnormalized values are cleared
+    void normalizeDensityValues(QuantileSketch& densitySketch) {
+        NumberColumn* pDensityVector = _dataSource.getDensityVector();
+        NormalizeData normalizeData;
+        normalizeData.normalize(pDensityVector, true);
+        _dataSource.invalidateDensityIndex();
+
+        densitySketch.transform([&](float d) {
+            return normalizeData.getNormalizedNumber(pDensityVector, d, true);
+        });
+        _dataSource.setDensitySketch(densitySketch);
+        pDensityVector->getValueVector().clear();
+    }
+
     DataSource& _dataSource;
     VpTree* _vpTree;
     int _nNearestNeighbors;
@@ -0,0 +1,69 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef DENSITY_INDEX
+#define DENSITY_INDEX
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Sorted copy of normalized density values. Quantiles are answered in
+// constant and inverse quantiles in logarithmic time with the same results
+// as nth_element and a counting pass over the unsorted values. NaN values
+// are sorted last and never counted.
+class DensityIndex {
+public:
+    DensityIndex(): _built(false) {
+    }
+
+    template<class V> void build(const V& densityVector) {
+        _sortedVector.assign(densityVector.begin(), densityVector.end());
+        sort(_sortedVector.begin(), _sortedVector.end(), [](float a, float b) {
+            return a < b || (!isnan(a) && isnan(b));
+        });
+        _built = true;
+    }
+    void clear() {
+        vector<float>().swap(_sortedVector);
+        _built = false;
+    }
+    bool isBuilt() const {
+        return _built;
+    }
+    int getSize() const {
+        return _sortedVector.size();
+    }
+
+    float getQuantile(float percent) const {
+        if(_sortedVector.empty()) {
+            return 0;
+        }
+        int n = (int)floor(percent / (float)100 * (float)_sortedVector.size()) - 1;
+        if(n < 0) {
+            n = 0;
+        }
+        if(n >= (int)_sortedVector.size()) {
+            n = _sortedVector.size() - 1;
+        }
+        return _sortedVector[n];
+    }
+    float getInverseQuantile(float densityValue) const {
+        if(_sortedVector.empty() || isnan(densityValue)) {
+            return 0;
+        }
+        vector<float>::const_iterator end = lower_bound(_sortedVector.begin(), _sortedVector.end(), densityValue, [](float a, float b) {
+            return !isnan(a) && a <= b;
+        });
+        float k = end - _sortedVector.begin();
+        return k / (float)_sortedVector.size() * 100;
+    }
+
+private:
+    vector<float> _sortedVector;
+    bool _built;
+};
+
+#endif
@@ -7,9 +7,13 @@ using namespace std;
 
 //#include "normalizeData.h"
 #include "density.h"
+#include "outlierScores.h"
+#include "csvReader.h"
 
 namespace dsInt {
     DataSource* pDataSource = 0;
+    bool compression = false;
+    string pageDirectory = "";
 }
 
 //' Write a data source to file
@@ -34,11 +38,12 @@ void dsWrite(const std::string& fileName) {
             throw string("No datasource");
         }
     
-        ofstream outFile;
-        outFile.open(fileName.c_str(), ios::binary);
-        if(!outFile.is_open()) {
+        OutStream outFile;
+        outFile.open(fileName);
+        if(!outFile.isOpen()) {
             throw string("File " + fileName + " could not be opened");
         }
+        outFile.setCompression(dsInt::compression);
         
         NormalizeData normalizeData;
         normalizeData.normalize(*dsInt::pDataSource);
@@ -52,6 +57,49 @@ void dsWrite(const std::string& fileName) {
     }
 }
 
+//' Set compression of data source files
+//'
+//' Enable or disable compression of data source files written by dsWrite(). Columns
+//' are compressed in blocks, for each block the smallest of bit-packing, delta bit-packing
+//' and byte-shuffled LZ compression is chosen. Compression is disabled by default.
+//'
+//' @param compression Boolean value indicating if files are written compressed
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' dsCreateWithDataFrame(iris)
+//' dsSetCompression(TRUE)
+//' dsWrite("ds.bin")}
+// [[Rcpp::export]]
+void dsSetCompression(bool compression) {
+    dsInt::compression = compression;
+}
+
+//' Set page directory of data sources
+//'
+//' Keep the column values, density values and normalized rows of data sources that are read or
+//' created with a CSV file in page files of a directory instead of memory. Page files are mapped
+//' into memory and column values are read into them block by block, so only the pages in use are
+//' resident and data sources larger than main memory can be read, normalized and used for density
+//' calculations. By default values are kept in memory.
+//'
+//' @param pageDirectory Directory of page files, an empty string keeps values in memory
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' dsSetPageDirectory(tempdir())
+//' dsCalculateDensityValues("ds.bin", 20)}
+// [[Rcpp::export]]
+void dsSetPageDirectory(const std::string& pageDirectory) {
+    dsInt::pageDirectory = pageDirectory;
+}
+
 //' Read a data source from file
 //'
 //' Read a data source from a file in binary format
@@ -70,15 +118,16 @@ void dsWrite(const std::string& fileName) {
 // [[Rcpp::export]]
 bool dsRead(const std::string& fileName) {
     try {
-        ifstream is;
-        is.open(fileName.c_str(), ios::binary);
-        if(!is.is_open()) {
+        InStream is;
+        is.open(fileName);
+        if(!is.isOpen()) {
             //throw string("File " + fileName + " could not be opened");
             return false;
         }
     
         delete dsInt::pDataSource;
         dsInt::pDataSource = new DataSource();
+        dsInt::pDataSource->setPageDirectory(dsInt::pageDirectory);
         dsInt::pDataSource->read(is);
         is.close();
         
@@ -90,6 +139,44 @@ bool dsRead(const std::string& fileName) {
     }
 }
 
+//' Create a data source with a CSV file
+//'
+//' Create a data source with the columns of a CSV file with a header line. The file is read in parallel.
+//' Columns containing only numbers and missing values are numerical, all other columns are of type string.
+//' Empty fields and NA denote missing values. Column names have to be unique.
+//'
+//' @param fileName Name of CSV file
+//' @param columnNames Names of columns to be read, by default all columns are read
+//' @param separator Field separator
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' write.csv(iris, "iris.csv", row.names = FALSE)
+//' dsCreateWithCsvFile("iris.csv")
+//' dsDeactivateColumns(c(5))
+//' dsWrite("ds.bin")}
+// [[Rcpp::export]]
+void dsCreateWithCsvFile(const std::string& fileName, CharacterVector columnNames = CharacterVector::create(), const std::string& separator = ",") {
+    try {
+        if(separator.size() != 1) {
+            throw string("Separator must be a single character");
+        }
+    
+        CsvReader csvReader(separator[0]);
+        DataSource* pDataSource = csvReader.read(fileName, Rcpp::as<vector<string> >(columnNames));
+        delete dsInt::pDataSource;
+        dsInt::pDataSource = pDataSource;
+        dsInt::pDataSource->setPageDirectory(dsInt::pageDirectory);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 // [[Rcpp::export]]
 void dsCreate(const std::vector<std::wstring>& columnTypes, const std::vector<std::wstring>& columnNames) {
     try {
@@ -103,7 +190,7 @@ void dsCreate(const std::vector<std::wstring>& columnTypes, const std::vector<st
                 enumColumnTypes.push_back(Column::STRING);
             }
         }
-        dsInt::pDataSource = new DataSource(enumColumnTypes, columnNames);
+        dsInt::pDataSource = new DataSource(enumColumnTypes, ToUtf8()(columnNames));
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -118,7 +205,37 @@ void dsAddValueRow(const std::vector<std::wstring>& valueVector) {
             throw string("No datasource");
         }
     
-        dsInt::pDataSource->addValueRow(valueVector);
+        dsInt::pDataSource->addValueRow(ToUtf8()(valueVector));
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+void dsAddNumberColumnValues(int columnIndex, NumericVector values) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No datasource");
+        }
+
+        dsInt::pDataSource->addNumberColumnValues(columnIndex, values.begin(), values.size());
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+void dsAddStringColumnValues(int columnIndex, IntegerVector codes, const std::vector<std::string>& levels) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No datasource");
+        }
+
+        dsInt::pDataSource->addStringColumnValues(columnIndex, levels, codes.begin(), codes.size());
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -221,7 +338,7 @@ std::vector<std::wstring> dsGetActiveColumnNames() {
             throw string("No datasource");
         }
     
-        return dsInt::pDataSource->getActiveColumnNames();
+        return FromUtf8()(dsInt::pDataSource->getActiveColumnNames());
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -250,7 +367,7 @@ std::vector<std::wstring> dsGetInactiveColumnNames() {
             throw string("No datasource");
         }
     
-        return dsInt::pDataSource->getInactiveColumnNames();
+        return FromUtf8()(dsInt::pDataSource->getInactiveColumnNames());
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -312,7 +429,7 @@ List dsGetRow(int index) {
         Column::COLUMN_TYPE type = columnVector[j]->getColumnType();
             if(type == Column::STRING) {
                 StringColumn* pStringColumn = dynamic_cast<StringColumn*>(columnVector[j]);
-                wstring value = pStringColumn->getValue(index - 1);
+                wstring value = FromUtf8()(pStringColumn->getValue(index - 1));
                 list.insert(list.end(), value);
             } else if(type == Column::NUMERICAL) {
                 vector<float> numberVector = columnVector[j]->getNumberVector(index - 1);
@@ -353,7 +470,7 @@ bool dsGetNormalized() {
 }
 
 // [[Rcpp::export]]
-void dsIntCalculateDensityValues(int nNearestNeighbors) {
+void dsIntCalculateDensityValues(int nNearestNeighbors, bool knnGraph = false) {
     try {
         if(dsInt::pDataSource == 0) {
             throw string("No dataSource");
@@ -363,9 +480,15 @@ void dsIntCalculateDensityValues(int nNearestNeighbors) {
         L2Distance l2Distance;
         Progress progress(dsInt::pDataSource->getNormalizedSize());
         VpTree vpTree;
-        vpTree.build(&vpDataSource, &l2Distance, 0);
+        bool hasKnnGraph = dsInt::pDataSource->hasKnnGraph(nNearestNeighbors);
+        if(!hasKnnGraph) {
+            vpTree.build(&vpDataSource, &l2Distance, 0);
+        }
         
         Density density(*dsInt::pDataSource, &vpTree, nNearestNeighbors, &progress);
+        if(knnGraph && !hasKnnGraph) {
+            density.calculateKnnGraph();
+        }
         density.calculateDensityValues();
         
         progress(dsInt::pDataSource->getNormalizedSize());
@@ -376,6 +499,83 @@ void dsIntCalculateDensityValues(int nNearestNeighbors) {
     }
 }
 
+//' Calculate outlier scores for a data source
+//'
+//' Calculate an outlier score for each row of a data source from its nearest neighbors among all rows.
+//' The local outlier factor compares the local reachability density of a row with the local reachability
+//' densities of its nearest neighbors, values around 1 denote inliers and larger values outliers. Otherwise
+//' the distance to the k-th nearest neighbor is returned. As for density values a row is its own nearest
+//' neighbor. Nearest neighbors are searched in parallel or taken from the graph of nearest neighbors if it
+//' was kept, see function dsCalculateDensityValues().
+//'
+//' @param nNearestNeighbors Number of used nearest neighbors
+//' @param localOutlierFactor Boolean value indicating if local outlier factors are calculated instead of
+//' distances to the k-th nearest neighbor
+//'
+//' @return Vector of outlier scores in the order of rows
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' dsRead("ds.bin")
+//' scores <- dsCalculateOutlierScores(20)}
+// [[Rcpp::export]]
+std::vector<float> dsCalculateOutlierScores(int nNearestNeighbors, bool localOutlierFactor = true) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No data source");
+        }
+
+        VpGenerativeData vpDataSource(*dsInt::pDataSource);
+        L2Distance l2Distance;
+        VpTree vpTree;
+        if(!dsInt::pDataSource->hasKnnGraph(nNearestNeighbors)) {
+            Progress progress(dsInt::pDataSource->getNormalizedSize());
+            vpTree.build(&vpDataSource, &l2Distance, &progress);
+        }
+
+        OutlierScores outlierScores(*dsInt::pDataSource, &vpTree, nNearestNeighbors);
+        if(localOutlierFactor) {
+            return outlierScores.calculateLocalOutlierFactors();
+        } else {
+            return outlierScores.calculateKNearestNeighborDistances();
+        }
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+std::vector<float> dsIntCalculateOutlierScoresForRecords(NumericMatrix dataRecords, int nNearestNeighbors, bool localOutlierFactor = true) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No data source");
+        }
+        if(dataRecords.ncol() != dsInt::pDataSource->getDimension()) {
+            throw string(cInvalidDimension);
+        }
+
+        VpGenerativeData vpDataSource(*dsInt::pDataSource);
+        L2Distance l2Distance;
+        Progress progress(dsInt::pDataSource->getNormalizedSize());
+        VpTree vpTree;
+        vpTree.build(&vpDataSource, &l2Distance, &progress);
+
+        OutlierScores outlierScores(*dsInt::pDataSource, &vpTree, nNearestNeighbors);
+        if(localOutlierFactor) {
+            return outlierScores.calculateLocalOutlierFactors(dataRecords.begin(), dataRecords.nrow());
+        } else {
+            return outlierScores.calculateKNearestNeighborDistances(dataRecords.begin(), dataRecords.nrow());
+        }
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 //' Calculate inverse density value quantile
 //' 
 //' Calculate inverse density value quantile for a density value. 
@@ -396,7 +596,7 @@ float dsDensityValueInverseQuantile(float densityValue) {
             throw string("No data source");
         }
         
-        if(dsInt::pDataSource->getDensityVector()->getNormalizedValueVector().size() == 0) {
+        if(!dsInt::pDataSource->hasDensityValues()) {
             throw string(cNoDensities);
         }
         
@@ -409,3 +609,75 @@ float dsDensityValueInverseQuantile(float densityValue) {
         ::Rf_error("C++ exception (unknown reason)");
     }
 }
+
+//' Calculate density value quantiles
+//'
+//' Calculate density value quantiles for a vector of percent values. All quantiles are
+//' taken from one sorted index of the density values.
+//'
+//' @param percents Vector of percent values
+//' @param approximate Boolean value indicating if quantiles are taken from a quantile sketch
+//' of density values with a rank error of about one percent instead of all density values
+//'
+//' @return Vector of normalized density value quantiles
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' dsRead("ds.bin")
+//' dsDensityValueQuantiles(c(10, 50, 90))}
+// [[Rcpp::export]]
+std::vector<float> dsDensityValueQuantiles(const std::vector<float>& percents, bool approximate = false) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No data source");
+        }
+
+        if(!dsInt::pDataSource->hasDensityValues()) {
+            throw string(cNoDensities);
+        }
+
+        Density density(*dsInt::pDataSource, 0, 0, 0);
+        return density.calculateQuantiles(percents, approximate);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Calculate inverse density value quantiles
+//'
+//' Calculate inverse density value quantiles for a vector of density values. All inverse
+//' quantiles are taken from one sorted index of the density values.
+//'
+//' @param densityValues Vector of normalized density values
+//' @param approximate Boolean value indicating if inverse quantiles are taken from a quantile sketch
+//' of density values with a rank error of about one percent instead of all density values
+//'
+//' @return Vector of percent values
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' dsRead("ds.bin")
+//' dsDensityValueInverseQuantiles(c(0.25, 0.5, 0.75))}
+// [[Rcpp::export]]
+std::vector<float> dsDensityValueInverseQuantiles(const std::vector<float>& densityValues, bool approximate = false) {
+    try {
+        if(dsInt::pDataSource == 0) {
+            throw string("No data source");
+        }
+
+        if(!dsInt::pDataSource->hasDensityValues()) {
+            throw string(cNoDensities);
+        }
+
+        Density density(*dsInt::pDataSource, 0, 0, 0);
+        return density.calculateInverseQuantiles(densityValues, approximate);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
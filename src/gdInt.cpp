@@ -7,10 +7,15 @@ using namespace Rcpp;
 using namespace std;
 
 #include "density.h"
+#include "outlierScores.h"
+#include "clustering.h"
+#include "representatives.h"
 #include "generativeModel.h"
+#include "batchSampler.h"
 
 const string cInvalidNearestNeighborsSize = "Invalid size of nearest neighbors";
 const string cDifferentListSizes = "Sizes of lists are different";
+const string cInvalidMatrixDimension = "Matrix dimensions are different from batch size or dimension of data source";
 
 namespace gdInt {
     GenerativeModel* pGenerativeModel = 0;
@@ -25,13 +30,24 @@ namespace gdInt {
     VpTreeData* pDensityVpTreeData = 0;
     LpDistance* pDensityLpDistance = 0;
 
+    BatchSampler* pBatchSampler = 0;
+
     string inGenerativeDataFileName = "";
     string inDataSourceFileName = "";
     int batchSize = 256;
     int maxSize = batchSize * 100000;
     int nNearestNeighbors = 20;
+    bool compression = false;
+    string pageDirectory = "";
 
     const string cMaxSizeExceeded = "Max size of generative data exceeded";
+
+    // The batch sampler reads the data source on its own thread, so it is
+    // stopped before the data source is deleted or replaced
+    void stopBatchSampler() {
+        delete pBatchSampler;
+        pBatchSampler = 0;
+    }
 }
 
 std::wstring ToWstring(std::string Str) {
@@ -45,6 +61,7 @@ std::wstring ToWstring(std::string Str) {
 // [[Rcpp::export]]
 void gdReset() {
     try {
+        gdInt::stopBatchSampler();
         delete gdInt::pGenerativeModel;
         gdInt::pGenerativeModel = 0;
         delete gdInt::pDataSource;
@@ -145,11 +162,12 @@ void gdCreateGenerativeModel() {
 // [[Rcpp::export]]
 void gdWriteWithReadingTrainedModel(const std::string& outFileName) {
     try {
-        ofstream os;
-        os.open(outFileName.c_str(), std::ios::binary);
-        if(!os.is_open()) {
+        OutStream os;
+        os.open(outFileName);
+        if(!os.isOpen()) {
             throw string("File " + outFileName + " could not be opened");
         }
+        os.setCompression(gdInt::compression);
 
         //delete gdInt::pGenerativeModel;
         //gdInt::pGenerativeModel = new GenerativeModel(*gdInt::pDataSource);
@@ -166,9 +184,9 @@ void gdWriteWithReadingTrainedModel(const std::string& outFileName) {
 // [[Rcpp::export]]
 bool gdReadGenerativeModel(const std::string& inFileName) {
     try {
-        ifstream is;
-        is.open(inFileName.c_str(), std::ios::binary);
-        if(!is.is_open()) {
+        InStream is;
+        is.open(inFileName);
+        if(!is.isOpen()) {
             //throw string("File " + inFileName + " could not be opened");
             return false;
         }
@@ -190,15 +208,17 @@ bool gdReadGenerativeModel(const std::string& inFileName) {
 // [[Rcpp::export]]
 void gdDataSourceRead(const std::string& inFileName) {
     try {
-        ifstream is;
-        is.open(inFileName.c_str(), std::ios::binary);
-        if(!is.is_open()) {
+        InStream is;
+        is.open(inFileName);
+        if(!is.isOpen()) {
             throw string("File " + inFileName + " could not be opened");
         }
         gdInt::inDataSourceFileName = inFileName;
 
+        gdInt::stopBatchSampler();
         delete gdInt::pDataSource;
         gdInt::pDataSource = new DataSource();
+        gdInt::pDataSource->setPageDirectory(gdInt::pageDirectory);
         gdInt::pDataSource->read(is);
         is.close();
 
@@ -212,9 +232,9 @@ void gdDataSourceRead(const std::string& inFileName) {
 // [[Rcpp::export]]
 bool gdGenerativeDataRead(const std::string& inFileName) {
     try {
-        ifstream is;
-        is.open(inFileName.c_str(), std::ios::binary);
-        if(!is.is_open()) {
+        InStream is;
+        is.open(inFileName);
+        if(!is.isOpen()) {
             //throw string("File " + inFileName + " could not be opened");
             return false;
         }
@@ -222,6 +242,7 @@ bool gdGenerativeDataRead(const std::string& inFileName) {
 
         delete gdInt::pGenerativeData;
         gdInt::pGenerativeData = new GenerativeData();
+        gdInt::pGenerativeData->setPageDirectory(gdInt::pageDirectory);
         gdInt::pGenerativeData->read(is);
         is.close();
 
@@ -244,11 +265,12 @@ void gdGenerativeDataWrite(const std::string& outFileName) {
             throw string("No generative data");
         }
 
-        ofstream outFile;
-        outFile.open(outFileName.c_str(), std::ios::binary);
-        if(!outFile.is_open()) {
+        OutStream outFile;
+        outFile.open(outFileName);
+        if(!outFile.isOpen()) {
             throw string("File " + outFileName + " could not be opened");
         }
+        outFile.setCompression(gdInt::compression);
 
         gdInt::pGenerativeData->DataSource::write(outFile);
         outFile.close();
@@ -259,6 +281,39 @@ void gdGenerativeDataWrite(const std::string& outFileName) {
     }
 }
 
+// Write the rows with indices of generative data with their density values and cluster labels
+void gdWriteSubsetRows(const std::string& fileName, const vector<int>& indices) {
+    OutStream outFile;
+    outFile.open(fileName);
+    if(!outFile.isOpen()) {
+        throw string("File " + fileName + " could not be opened");
+    }
+    outFile.setCompression(gdInt::compression);
+
+    GenerativeData generativeData(dynamic_cast<DataSource&>(*gdInt::pGenerativeData));
+    for(int i = 0; i < (int)indices.size(); i++) {
+        vector<float> normalizedNumberVector = gdInt::pGenerativeData->getNormalizedNumberVector(indices[i]);
+        generativeData.addValueLine(normalizedNumberVector);
+    }
+
+    if(gdInt::pGenerativeData->hasDensityValues()) {
+        generativeData.getDensityVector()->getNormalizedValueVector().resize(indices.size(), 0);
+        for(int i = 0; i < (int)indices.size(); i++) {
+            generativeData.getDensityVector()->getNormalizedValueVector()[i] = gdInt::pGenerativeData->getDensityVector()->getNormalizedValueVector()[indices[i]];
+        }
+    }
+
+    if(gdInt::pGenerativeData->hasClusterLabels()) {
+        generativeData.getClusterLabels().resize(indices.size(), 0);
+        for(int i = 0; i < (int)indices.size(); i++) {
+            generativeData.getClusterLabels()[i] = gdInt::pGenerativeData->getClusterLabels()[indices[i]];
+        }
+    }
+
+    generativeData.DataSource::write(outFile);
+    outFile.close();
+}
+
 //' Write subset of generative data
 //'
 //' Write subset of randomly selected rows of generative data
@@ -280,30 +335,122 @@ void gdWriteSubset(const std::string& fileName, float percent) {
             throw string("No generative data");
         }
 
-        ofstream outFile;
-        outFile.open(fileName.c_str(), std::ios::binary);
-        if(!outFile.is_open()) {
-            throw string("File " + fileName + " could not be opened");
-        }
-
         vector<int> randomIndices = RandomIndicesWithoutReplacement()(gdInt::pGenerativeData->getNormalizedSize(), percent);
-        sort(randomIndices.begin(), randomIndices.end());
+        gdWriteSubsetRows(fileName, randomIndices);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
 
-        GenerativeData generativeData(dynamic_cast<DataSource&>(*gdInt::pGenerativeData));
-        for(int i = 0; i < (int)randomIndices.size(); i++) {
-            vector<float> normalizedNumberVector = gdInt::pGenerativeData->getNormalizedNumberVector(randomIndices[i]);
-            generativeData.addValueLine(normalizedNumberVector);
+//' Write representative subset of generative data
+//'
+//' Write a subset of representative rows of generative data which covers the distribution of generative data.
+//' Representatives are selected with density weighted farthest point sampling: the next representative is the
+//' row farthest from its nearest representative relative to the distance to its k-th nearest neighbor. So the
+//' number of representatives in a region is about proportional to the number of rows in it, while sparse regions
+//' are still covered. Nearest neighbors are searched in parallel or taken from the graph of nearest neighbors if
+//' it was kept, see function gdCalculateDensityValues().
+//'
+//' @param fileName Name of subset generative data file
+//' @param size Number of representative rows
+//'
+//' @return Vector containing for each row of the subset the number of rows of generative data to which it is
+//' the nearest representative
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' weights <- gdWriteRepresentativeSubset("gds.bin", 1000)}
+// [[Rcpp::export]]
+std::vector<int> gdWriteRepresentativeSubset(const std::string& fileName, int size) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
         }
 
-        if(gdInt::pGenerativeData->getDensityVector()->getNormalizedSize() > 0) {
-            generativeData.getDensityVector()->getNormalizedValueVector().resize(randomIndices.size(), 0);
-            for(int i = 0; i < (int)randomIndices.size(); i++) {
-                generativeData.getDensityVector()->getNormalizedValueVector()[i] = gdInt::pGenerativeData->getDensityVector()->getNormalizedValueVector()[randomIndices[i]];
-            }
-        }
+        VpGenerativeData vpGenerativeData(*gdInt::pGenerativeData);
+        L2Distance l2Distance;
+        Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+        VpTree vpTree;
+        vpTree.build(&vpGenerativeData, &l2Distance, &progress);
 
-        generativeData.DataSource::write(outFile);
-        outFile.close();
+        Representatives representatives(*gdInt::pGenerativeData, &vpTree, gdInt::nNearestNeighbors);
+        vector<int> weights;
+        vector<int> indices = representatives.select(size, weights);
+        gdWriteSubsetRows(fileName, indices);
+        return weights;
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Set seed of random number generation
+//'
+//' Set the seed of the random number generators used for sampling, imputation of missing values
+//' and selection of random subsets. Generators created after this call produce reproducible sequences.
+//'
+//' @param seed Seed of random number generation
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdSetSeed(1)
+//' gdRead("gd.bin")
+//' gdWriteSubset("gds.bin", 50)}
+// [[Rcpp::export]]
+void gdSetSeed(int seed) {
+    Rng::SetSeed((uint32_t)seed);
+}
+
+//' Set compression of generative data files
+//'
+//' Enable or disable compression of generative data and generative model files. Columns
+//' are compressed in blocks, for each block the smallest of bit-packing, delta bit-packing
+//' and byte-shuffled LZ compression is chosen. Compression is disabled by default.
+//'
+//' @param compression Boolean value indicating if files are written compressed
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdSetCompression(TRUE)
+//' gdRead("gd.bin")
+//' gdWriteSubset("gds.bin", 50)}
+// [[Rcpp::export]]
+void gdSetCompression(bool compression) {
+    gdInt::compression = compression;
+}
+
+//' Set number of nearest neighbors for density values
+//'
+//' Set the number of nearest neighbors used to calculate density values of generative data
+//' and data records. The default number is 20.
+//'
+//' @param nNearestNeighbors Number of nearest neighbors
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdSetNumberOfNearestNeighbors(10)
+//' gdCalculateDensityValues("gd.bin")}
+// [[Rcpp::export]]
+void gdSetNumberOfNearestNeighbors(int nNearestNeighbors) {
+    try {
+        if(nNearestNeighbors <= 0) {
+            throw string(cInvalidNearestNeighbors);
+        }
+        gdInt::nNearestNeighbors = nNearestNeighbors;
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -311,6 +458,28 @@ void gdWriteSubset(const std::string& fileName, float percent) {
     }
 }
 
+//' Set page directory of data sources and generative data
+//'
+//' Keep the column values, density values and normalized rows of data sources and generative data
+//' in page files of a directory instead of memory. Page files are mapped into memory and column
+//' values are read into them block by block, so only the pages in use are resident and data larger
+//' than main memory can be read, normalized, sampled for training and used for density calculations.
+//' Page files are removed when the data is released. By default values are kept in memory.
+//'
+//' @param pageDirectory Directory of page files, an empty string keeps values in memory
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdSetPageDirectory(tempdir())
+//' gdTrain("gm.bin", "gd.bin", "ds.bin", c(1, 2))}
+// [[Rcpp::export]]
+void gdSetPageDirectory(const std::string& pageDirectory) {
+    gdInt::pageDirectory = pageDirectory;
+}
+
 // [[Rcpp::export]]
 void gdCreateGenerativeData() {
     try {
@@ -320,6 +489,7 @@ void gdCreateGenerativeData() {
 
         delete gdInt::pGenerativeData;
         gdInt::pGenerativeData = new GenerativeData(*gdInt::pDataSource);
+        gdInt::pGenerativeData->setPageDirectory(gdInt::pageDirectory);
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -334,8 +504,10 @@ void gdCreateDataSourceFromGenerativeModel() {
             throw string("generative model");
         }
 
+        gdInt::stopBatchSampler();
         delete gdInt::pDataSource;
         gdInt::pDataSource = new DataSource(gdInt::pGenerativeModel->getDataSource());
+        gdInt::pDataSource->setPageDirectory(gdInt::pageDirectory);
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -375,6 +547,72 @@ std::vector<float> gdDataSourceGetNormalizedDataRandom(int rowCount) {
     }
 }
 
+// [[Rcpp::export]]
+NumericMatrix gdDataSourceGetNormalizedDataRandomMatrix(NumericMatrix samples) {
+    try {
+        if(gdInt::pDataSource == 0) {
+            throw string("No datasource");
+        }
+        if(samples.ncol() != gdInt::pDataSource->getDimension()) {
+            throw string(cInvalidMatrixDimension);
+        }
+
+        gdInt::pDataSource->getNormalizedDataRandom(samples.begin(), samples.nrow());
+        return samples;
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+void gdBatchSamplerStart(int seed, bool epochs) {
+    try {
+        if(gdInt::pDataSource == 0) {
+            throw string("No datasource");
+        }
+
+        gdInt::stopBatchSampler();
+        gdInt::pBatchSampler = new BatchSampler(*gdInt::pDataSource, gdInt::batchSize, seed, epochs);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+List gdBatchSamplerNext(NumericMatrix samples, NumericMatrix noise) {
+    try {
+        if(gdInt::pBatchSampler == 0) {
+            throw string("No batch sampler");
+        }
+        if(samples.nrow() != gdInt::pBatchSampler->getBatchSize() || samples.ncol() != gdInt::pBatchSampler->getDimension() ||
+            noise.nrow() != samples.nrow() || noise.ncol() != samples.ncol()) {
+            throw string(cInvalidMatrixDimension);
+        }
+
+        gdInt::pBatchSampler->next(samples.begin(), noise.begin());
+        return List::create(samples, noise);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+void gdBatchSamplerStop() {
+    try {
+        gdInt::stopBatchSampler();
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 // [[Rcpp::export]]
 std::vector<float> gdDataSourceGetNormalizedDataRandomReference(int rowCount) {
     try {
@@ -448,7 +686,7 @@ std::vector<std::vector<float>> gdGenerativeDataGetDenormalizedDataRandomWithDen
             throw string("No generative data");
         }
 
-        if(gdInt::pGenerativeData->getDensityVector()->getNormalizedValueVector().size() == 0) {
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
             throw string(cNoDensities);
         }
 
@@ -491,13 +729,49 @@ int gdGetDataSourceDimension() {
 }
 
 // [[Rcpp::export]]
-void gdAddValueRows(const std::vector<float>& valueRows) {
+void gdAddValueRows(NumericVector valueRows) {
     try {
         if(gdInt::pGenerativeData == 0) {
             throw string("No generative data");
         }
 
-        gdInt::pGenerativeData->addValueLines(valueRows);
+        gdInt::pGenerativeData->addValueLines(valueRows.begin(), valueRows.size(), gdInt::maxSize);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+int gdAddValueRowsWithThreshold(NumericMatrix samples, NumericVector probabilities, double threshold) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+        if(samples.ncol() != gdInt::pGenerativeData->getDimension() || probabilities.size() != samples.nrow()) {
+            throw string(cInvalidMatrixDimension);
+        }
+
+        return gdInt::pGenerativeData->addValueLines(samples.begin(), samples.nrow(), probabilities.begin(), threshold, gdInt::maxSize);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+NumericVector gdGetAcceptCounts() {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        NumericVector counts(2);
+        counts[0] = gdInt::pGenerativeData->getGeneratedRowCount();
+        counts[1] = gdInt::pGenerativeData->getAcceptedRowCount();
+        return counts;
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -541,7 +815,7 @@ std::vector<std::wstring> gdGetColumnNames(std::vector<int>& indexVector) {
         for(int i = 0; i < (int)indexVector.size(); i++) {
             indexVector[i] -= 1;
         }
-        vector<wstring> columnNames = gdInt::pGenerativeData->getColumnNames(indexVector);
+        vector<wstring> columnNames = FromUtf8()(gdInt::pGenerativeData->getColumnNames(indexVector));
         return columnNames;
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
@@ -576,7 +850,7 @@ std::vector<std::wstring> gdGetNumberVectorIndexNames(std::vector<int>& numberVe
         for(int i = 0; i < (int)indexVector.size(); i++) {
             indexVector[i] -= 1;
         }
-        vector<wstring> numberVectorIndexNames = gdInt::pGenerativeData->getNumbeVectorIndexNames(indexVector);
+        vector<wstring> numberVectorIndexNames = FromUtf8()(gdInt::pGenerativeData->getNumbeVectorIndexNames(indexVector));
         return numberVectorIndexNames;
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
@@ -615,7 +889,7 @@ List gdGetRow(int index) {
                 list.insert(list.end(), value);
             } else if(type == Column::NUMERICAL_ARRAY) {
                 NumberArrayColumn* pNumberArrayColumn = dynamic_cast<NumberArrayColumn*>(columnVector[i]);
-                wstring value = pNumberArrayColumn->getMaxValue(index - 1);
+                wstring value = FromUtf8()(pNumberArrayColumn->getMaxValue(index - 1));
                 list.insert(list.end(), value);
             } else {
                 throw string(cInvalidColumnType);
@@ -701,6 +975,9 @@ void gdResetDensitiyValues() {
         }
 
         gdInt::pGenerativeData->getDensityVector()->clear();
+        gdInt::pGenerativeData->clearDensityRadii();
+        gdInt::pGenerativeData->invalidateDensityIndex();
+        gdInt::pGenerativeData->setDensitySketch(QuantileSketch());
     } catch (const string& e) {
         ::Rf_error("%s", e.c_str());
     } catch(...) {
@@ -709,7 +986,7 @@ void gdResetDensitiyValues() {
 }
 
 // [[Rcpp::export]]
-void gdIntCalculateDensityValues() {
+void gdIntCalculateDensityValues(bool incremental = false, bool knnGraph = false) {
     try {
         if(gdInt::pGenerativeData == 0) {
             throw string("No generative data");
@@ -719,10 +996,23 @@ void gdIntCalculateDensityValues() {
         L2Distance l2Distance;
         Progress progress(gdInt::pGenerativeData->getNormalizedSize());
         VpTree vpTree;
-        vpTree.build(&vpGenerativeData, &l2Distance, 0);
+        bool hasKnnGraph = gdInt::pGenerativeData->hasKnnGraph(gdInt::nNearestNeighbors);
+        if(incremental || !hasKnnGraph) {
+            vpTree.build(&vpGenerativeData, &l2Distance, 0);
+        }
 
         Density density(*gdInt::pGenerativeData, &vpTree, gdInt::nNearestNeighbors, &progress);
-        density.calculateDensityValues();
+        if(incremental) {
+            density.updateDensityValues();
+            if(knnGraph) {
+                density.calculateKnnGraph();
+            }
+        } else {
+            if(knnGraph && !hasKnnGraph) {
+                density.calculateKnnGraph();
+            }
+            density.calculateDensityValues();
+        }
 
         progress(gdInt::pGenerativeData->getNormalizedSize());
     } catch (const string& e) {
@@ -732,6 +1022,115 @@ void gdIntCalculateDensityValues() {
     }
 }
 
+// [[Rcpp::export]]
+void gdIntCalculateDensityValuesForNearestNeighbors(std::vector<int> nNearestNeighbors) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        VpGenerativeData vpGenerativeData(*gdInt::pGenerativeData);
+        L2Distance l2Distance;
+        Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+        VpTree vpTree;
+        int maxNearestNeighbors = nNearestNeighbors.empty() ? 0 : *max_element(nNearestNeighbors.begin(), nNearestNeighbors.end());
+        if(!gdInt::pGenerativeData->hasKnnGraph(maxNearestNeighbors)) {
+            vpTree.build(&vpGenerativeData, &l2Distance, 0);
+        }
+
+        Density density(*gdInt::pGenerativeData, &vpTree, gdInt::nNearestNeighbors, &progress);
+        density.calculateDensityValues(nNearestNeighbors);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Select density values for a number of nearest neighbors
+//'
+//' Select density values of read in generative data that were calculated for a number of
+//' nearest neighbors in gdCalculateDensityValuesForNearestNeighbors(). Selected density values
+//' are used in quantile functions, gdPlotProjection() and gdWriteSubset(). Density values for
+//' several numbers of nearest neighbors are removed when density values are calculated in
+//' gdCalculateDensityValues(), so they always belong to the current rows.
+//'
+//' @param nNearestNeighbors Number of nearest neighbors
+//'
+//' @return None
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin", "ds.bin")
+//' gdSelectDensityValues(50)
+//' gdDensityValueQuantile(50)}
+// [[Rcpp::export]]
+void gdSelectDensityValues(int nNearestNeighbors) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        gdInt::pGenerativeData->selectDensityVector(nNearestNeighbors);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Get numbers of nearest neighbors of density values
+//'
+//' Get the numbers of nearest neighbors for which density values of read in generative data
+//' were calculated in gdCalculateDensityValuesForNearestNeighbors().
+//'
+//' @return Vector of numbers of nearest neighbors in ascending order
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' gdGetDensityNearestNeighbors()}
+// [[Rcpp::export]]
+std::vector<int> gdGetDensityNearestNeighbors() {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        return gdInt::pGenerativeData->getDensityNearestNeighbors();
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+List gdIntCalculateApproximateDensityValues(int sampleSize, int holdoutSize) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+        Density density(*gdInt::pGenerativeData, 0, gdInt::nNearestNeighbors, &progress);
+        DensityErrors densityErrors = density.calculateApproximateDensityValues(sampleSize, holdoutSize);
+
+        return List::create(Named("holdoutSize") = densityErrors.holdoutSize,
+                            Named("zeroExactValues") = densityErrors.zeroExactValues,
+                            Named("meanRelativeError") = densityErrors.meanRelativeError,
+                            Named("medianRelativeError") = densityErrors.medianRelativeError,
+                            Named("maxRelativeError") = densityErrors.maxRelativeError,
+                            Named("meanNormalizedError") = densityErrors.meanNormalizedError);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 //' Calculate density value for a data record
 //'
 //' Calculate density value for a data record.
@@ -795,6 +1194,191 @@ float gdCalculateDensityValue(List dataRecord, bool useSearchTree = false) {
     }
 }
 
+// [[Rcpp::export]]
+std::vector<float> gdIntCalculateDensityValuesForRecords(NumericMatrix dataRecords, bool useSearchTree = true) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
+            throw string(cNoDensities);
+        }
+        if(dataRecords.ncol() != gdInt::pGenerativeData->getDimension()) {
+            throw string(cInvalidDimension);
+        }
+
+        if(useSearchTree) {
+            if(gdInt::pDensityVpTree == 0) {
+                gdInt::pDensityVpTree = new VpTree();
+                Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+                delete gdInt::pDensityVpTreeData;
+                gdInt::pDensityVpTreeData = new VpGenerativeData(*gdInt::pGenerativeData);
+                delete gdInt::pDensityLpDistance;
+                gdInt::pDensityLpDistance = new L2Distance;
+
+                gdInt::pDensityVpTree->build(gdInt::pDensityVpTreeData, gdInt::pDensityLpDistance, &progress);
+            }
+        }
+
+        vector<float> densityValues;
+        if(useSearchTree) {
+            Density density(*gdInt::pGenerativeData, gdInt::pDensityVpTree, gdInt::nNearestNeighbors, 0);
+            densityValues = density.calculateDensityValues(dataRecords.begin(), dataRecords.nrow());
+        } else {
+            VpGenerativeData vpGenerativeData(*gdInt::pGenerativeData);
+            L2Distance l2Distance;
+            VpTree vpTree(&vpGenerativeData, &l2Distance, 0);
+            Density density(*gdInt::pGenerativeData, &vpTree, gdInt::nNearestNeighbors, 0);
+            densityValues = density.calculateDensityValues(dataRecords.begin(), dataRecords.nrow());
+        }
+        return densityValues;
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Calculate outlier scores for generative data
+//'
+//' Calculate an outlier score for each row of generative data from its nearest neighbors among all rows.
+//' The local outlier factor compares the local reachability density of a row with the local reachability
+//' densities of its nearest neighbors, values around 1 denote inliers and larger values outliers. Otherwise
+//' the distance to the k-th nearest neighbor is returned. As for density values a row is its own nearest
+//' neighbor. Nearest neighbors are searched in parallel or taken from the graph of nearest neighbors if it
+//' was kept, see function gdCalculateDensityValues().
+//'
+//' @param localOutlierFactor Boolean value indicating if local outlier factors are calculated instead of
+//' distances to the k-th nearest neighbor
+//'
+//' @return Vector of outlier scores in the order of rows
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' scores <- gdCalculateOutlierScores()}
+// [[Rcpp::export]]
+std::vector<float> gdCalculateOutlierScores(bool localOutlierFactor = true) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        VpGenerativeData vpGenerativeData(*gdInt::pGenerativeData);
+        L2Distance l2Distance;
+        VpTree vpTree;
+        if(!gdInt::pGenerativeData->hasKnnGraph(gdInt::nNearestNeighbors)) {
+            Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+            vpTree.build(&vpGenerativeData, &l2Distance, &progress);
+        }
+
+        OutlierScores outlierScores(*gdInt::pGenerativeData, &vpTree, gdInt::nNearestNeighbors);
+        if(localOutlierFactor) {
+            return outlierScores.calculateLocalOutlierFactors();
+        } else {
+            return outlierScores.calculateKNearestNeighborDistances();
+        }
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+std::vector<float> gdIntCalculateOutlierScoresForRecords(NumericMatrix dataRecords, bool localOutlierFactor = true) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+        if(dataRecords.ncol() != gdInt::pGenerativeData->getDimension()) {
+            throw string(cInvalidDimension);
+        }
+
+        if(gdInt::pDensityVpTree == 0) {
+            gdInt::pDensityVpTree = new VpTree();
+            Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+            delete gdInt::pDensityVpTreeData;
+            gdInt::pDensityVpTreeData = new VpGenerativeData(*gdInt::pGenerativeData);
+            delete gdInt::pDensityLpDistance;
+            gdInt::pDensityLpDistance = new L2Distance;
+
+            gdInt::pDensityVpTree->build(gdInt::pDensityVpTreeData, gdInt::pDensityLpDistance, &progress);
+        }
+
+        OutlierScores outlierScores(*gdInt::pGenerativeData, gdInt::pDensityVpTree, gdInt::nNearestNeighbors);
+        if(localOutlierFactor) {
+            return outlierScores.calculateLocalOutlierFactors(dataRecords.begin(), dataRecords.nrow());
+        } else {
+            return outlierScores.calculateKNearestNeighborDistances(dataRecords.begin(), dataRecords.nrow());
+        }
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+// [[Rcpp::export]]
+std::vector<int> gdIntCalculateClusters(float radius, int minPoints, bool hierarchical = false, int minClusterSize = 100) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        VpGenerativeData vpGenerativeData(*gdInt::pGenerativeData);
+        L2Distance l2Distance;
+        VpTree vpTree;
+        if(!hierarchical || !gdInt::pGenerativeData->hasKnnGraph(minPoints)) {
+            Progress progress(gdInt::pGenerativeData->getNormalizedSize());
+            vpTree.build(&vpGenerativeData, &l2Distance, &progress);
+        }
+
+        Clustering clustering(*gdInt::pGenerativeData, &vpTree);
+        vector<int>& clusterLabels = gdInt::pGenerativeData->getClusterLabels();
+        if(hierarchical) {
+            clusterLabels = clustering.calculateHierarchicalLabels(minPoints, minClusterSize);
+        } else {
+            clusterLabels = clustering.calculateDbscanLabels(radius, minPoints);
+        }
+        return clusterLabels;
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Get cluster labels
+//'
+//' Get the cluster labels of the rows of generative data calculated by function gdCalculateClusters().
+//'
+//' @return Vector of cluster labels in the order of rows, 0 denotes noise
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' labels <- gdGetClusterLabels()}
+// [[Rcpp::export]]
+std::vector<int> gdGetClusterLabels() {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+        if(!gdInt::pGenerativeData->hasClusterLabels()) {
+            throw string("No cluster labels");
+        }
+
+        return gdInt::pGenerativeData->getClusterLabels();
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 //' Calculate density value quantile
 //'
 //' Calculate density value quantile for a percent value.
@@ -815,7 +1399,7 @@ float gdDensityValueQuantile(float percent) {
             throw string("No generative data");
         }
 
-        if(gdInt::pGenerativeData->getDensityVector()->getNormalizedValueVector().size() == 0) {
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
             throw string(cNoDensities);
         }
 
@@ -853,7 +1437,7 @@ float gdDensityValueInverseQuantile(float densityValue) {
             throw string("No generative data");
         }
 
-        if(gdInt::pGenerativeData->getDensityVector()->getNormalizedValueVector().size() == 0) {
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
             throw string(cNoDensities);
         }
 
@@ -866,6 +1450,78 @@ float gdDensityValueInverseQuantile(float densityValue) {
     }
 }
 
+//' Calculate density value quantiles
+//'
+//' Calculate density value quantiles for a vector of percent values. All quantiles are
+//' taken from one sorted index of the density values.
+//'
+//' @param percents Vector of percent values
+//' @param approximate Boolean value indicating if quantiles are taken from a quantile sketch
+//' of density values with a rank error of about one percent instead of all density values
+//'
+//' @return Vector of normalized density value quantiles
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' gdDensityValueQuantiles(c(10, 50, 90))}
+// [[Rcpp::export]]
+std::vector<float> gdDensityValueQuantiles(const std::vector<float>& percents, bool approximate = false) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
+            throw string(cNoDensities);
+        }
+
+        Density density(*gdInt::pGenerativeData, 0, 0, 0);
+        return density.calculateQuantiles(percents, approximate);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
+//' Calculate inverse density value quantiles
+//'
+//' Calculate inverse density value quantiles for a vector of density values. All inverse
+//' quantiles are taken from one sorted index of the density values.
+//'
+//' @param densityValues Vector of normalized density values
+//' @param approximate Boolean value indicating if inverse quantiles are taken from a quantile sketch
+//' of density values with a rank error of about one percent instead of all density values
+//'
+//' @return Vector of percent values
+//' @export
+//'
+//' @examples
+//' \dontrun{
+//' gdRead("gd.bin")
+//' gdDensityValueInverseQuantiles(c(0.25, 0.5, 0.75))}
+// [[Rcpp::export]]
+std::vector<float> gdDensityValueInverseQuantiles(const std::vector<float>& densityValues, bool approximate = false) {
+    try {
+        if(gdInt::pGenerativeData == 0) {
+            throw string("No generative data");
+        }
+
+        if(!gdInt::pGenerativeData->hasDensityValues()) {
+            throw string(cNoDensities);
+        }
+
+        Density density(*gdInt::pGenerativeData, 0, 0, 0);
+        return density.calculateInverseQuantiles(densityValues, approximate);
+    } catch (const string& e) {
+        ::Rf_error("%s", e.c_str());
+    } catch(...) {
+        ::Rf_error("C++ exception (unknown reason)");
+    }
+}
+
 // [[Rcpp::export]]
 std::string gdBuildFileName(const std::string& fileName, float niveau) {
     try {
@@ -935,11 +1591,11 @@ List gdKNearestNeighbors(List dataRecord, int k = 1, bool useSearchTree = false)
                     ;
                 }
 
-                wstring value;
+                string value;
                 if(isnan(number)) {
                     value = cNA;
                 } else {
-                    value = as<wstring>(dataRecord[i]);
+                    value = ToUtf8()(as<wstring>(dataRecord[i]));
                 }
 
                 vector<float> columnNumberVector = pNumberArrayColumn->getNormalizedNumberVector(value);
@@ -1021,8 +1677,8 @@ List gdKNearestNeighbors(List dataRecord, int k = 1, bool useSearchTree = false)
                     completeDataRecord.insert(completeDataRecord.end(), value);
                 } else if(columnType == Column::NUMERICAL_ARRAY) {
                     NumberArrayColumn* pNumberArrayColumn = dynamic_cast<NumberArrayColumn*>(columnVector[j]);
-                    wstring value = pNumberArrayColumn->getMaxValue(nearestNeighbours[i].getIndex());
-                    completeDataRecord.insert(completeDataRecord.end(), value);
+                    string value = pNumberArrayColumn->getMaxValue(nearestNeighbours[i].getIndex());
+                    completeDataRecord.insert(completeDataRecord.end(), FromUtf8()(value));
                     if(value == cNA) {
                         isnanCount++;
                     }
@@ -1095,14 +1751,15 @@ List gdComplete(List dataRecord, bool useSearchTree = false) {
                     ;
                 }
 
+                wstring na = FromUtf8()(cNA);
                 wstring value;
                 if(isnan(number)) {
-                    value = cNA;
+                    value = na;
                 } else {
                     value = as<wstring>(dataRecord[i]);
                 }
                 wstring nearestNeighborValue = as<wstring>(nearestNeighbor[i]);
-                if(value == cNA) {
+                if(value == na) {
                     completedList.insert(completedList.end(), nearestNeighborValue);
                 } else {
                     completedList.insert(completedList.end(), value);
@@ -8,18 +8,18 @@
 
 using namespace std;
 
-const wstring cColumnNameSeparator = L" ";
+const string cColumnNameSeparator = " ";
 
 const string cInvalidVectorSize = "Invalid size of vector";
 const string cGenerativeDataSourceTypeId = "15e02d71-de25-4e2f-8b79-d9e1d7c4a5ed";
   
 class GenerativeData : public DataSource {
 public:
-	GenerativeData() {
+	GenerativeData(): _capacity(0), _generatedRowCount(0), _acceptedRowCount(0) {
 		_typeId = cGenerativeDataSourceTypeId;
 	}
     
-	GenerativeData(const DataSource& dataSource) {
+	GenerativeData(const DataSource& dataSource): _capacity(0), _generatedRowCount(0), _acceptedRowCount(0) {
 	   	_typeId = cGenerativeDataSourceTypeId;
 		_normalized = true;
 
@@ -33,9 +33,9 @@ public:
 			    if(scaleType == Column::NOMINAL) {
 			        const StringColumn* pStringColumn = dynamic_cast<const StringColumn*>(dataSource.getColumnVector()[i]);
 			        
-			        vector<wstring> columnNames;
-			        const map<int, wstring>& inverseValueMap = pStringColumn->getInverseValueMap();
-			        map<int, wstring>::const_iterator iter(inverseValueMap.begin());
+			        vector<string> columnNames;
+			        const map<int, string>& inverseValueMap = pStringColumn->getInverseValueMap();
+			        map<int, string>::const_iterator iter(inverseValueMap.begin());
 			        while(iter != inverseValueMap.end()) {
 			            columnNames.push_back(iter->second);
 			            iter++;
@@ -87,16 +87,48 @@ public:
 	}
 
 	void addValueLines(const vector<float>& valueVector) {
+		vector<double> v(valueVector.begin(), valueVector.end());
+		addValueLines(v.data(), v.size());
+	}
+
+	// Append rows stored row by row in p. The size is validated once, then
+	// each column takes its values in one pass. Capacity grows geometrically
+	// up to maxSize rows. When the normalized row cache is complete it is
+	// extended by the new rows.
+	void addValueLines(const double* p, size_t size, int maxSize = 0) {
 		int dimension = getDimension();
-		if(valueVector.size() % dimension != 0) {
+		if(dimension == 0 || size % dimension != 0) {
 			throw string(cInvalidVectorSize);
 		}
-		for(int i = 0; i < (int)valueVector.size() / dimension; i++) {
-			addValueLine(valueVector, i * dimension);
+		addValueLines(p, size / dimension, 0, dimension, 1, maxSize);
+	}
+
+	// Append the rows of the column-major matrix p of rowCount rows whose
+	// probability is greater or equal to threshold and count generated and
+	// accepted rows. Accepted rows are taken from p directly. Returns the
+	// number of accepted rows.
+	int addValueLines(const double* p, int rowCount, const double* probabilities, double threshold, int maxSize = 0) {
+		vector<int> indexVector;
+		for(int i = 0; i < rowCount; i++) {
+			if(probabilities[i] >= threshold) {
+				indexVector.push_back(i);
+			}
 		}
+		int acceptedRowCount = indexVector.size();
+		addValueLines(p, acceptedRowCount, indexVector.data(), 1, rowCount, maxSize);
+
+		_generatedRowCount += rowCount;
+		_acceptedRowCount += acceptedRowCount;
+		return acceptedRowCount;
+	}
+	double getGeneratedRowCount() const {
+		return _generatedRowCount;
+	}
+	double getAcceptedRowCount() const {
+		return _acceptedRowCount;
 	}
     
-	void read(ifstream& is) {
+	void read(InStream& is) {
 		InOut::Read(is, _typeId);
 		if(_typeId != cGenerativeDataSourceTypeId) {
 			throw string(cInvalidTypeId);
@@ -109,13 +141,59 @@ public:
 		    f("Density values have to be recalculated");
 		    delete _pDensityVector;
 		    _pDensityVector = new NumberColumn(Column::NUMERICAL, Column::LOGARITHMIC , cDensityColumn);
+		    _pDensityVector->setPageDirectory(_pageDirectory);
 		}
 		
 		buildNormalizedNumberVectorVector();
 	}
     
 private:
+	// Append rowCount rows of p, or the rowCount rows in indices if indices
+	// is not 0. Dimension j of row i is at p[i * rowStride + j * dimensionStride].
+	void addValueLines(const double* p, int rowCount, const int* indices, int rowStride, int dimensionStride, int maxSize) {
+		if(rowCount == 0) {
+			return;
+		}
+
+		int dimension = getDimension();
+		int normalizedSize = getNormalizedSize();
+		int requiredSize = normalizedSize + rowCount;
+		if(requiredSize > _capacity) {
+			_capacity = max(requiredSize, 2 * _capacity);
+			if(maxSize > 0) {
+				_capacity = max(requiredSize, min(_capacity, maxSize));
+			}
+			for(auto column : _columnVector) {
+				column->reserveNormalized(_capacity);
+			}
+		}
+
+		int offset = 0;
+		for(auto column : _columnVector) {
+			column->addNormalizedValues(p + (size_t)offset * dimensionStride, rowCount, indices, rowStride, dimensionStride);
+			offset += column->getDimension();
+		}
+
+		if(_rowMatrix.size() == normalizedSize) {
+			if(normalizedSize == 0) {
+				_rowMatrix.resize(0, dimension);
+			}
+			_rowMatrix.reserve(_capacity);
+			_rowMatrix.resize(requiredSize, dimension);
+			for(int i = 0; i < rowCount; i++) {
+				const double* q = p + (size_t)(indices != 0 ? indices[i] : i) * rowStride;
+				float* row = _rowMatrix[normalizedSize + i];
+				for(int j = 0; j < dimension; j++) {
+					row[j] = q[(size_t)j * dimensionStride];
+				}
+			}
+		}
+	}
+
 	vector<uniform_int_distribution<int>*> _pRVector;
+	int _capacity;
+	double _generatedRowCount;
+	double _acceptedRowCount;
 };
 
 #endif
@@ -24,6 +24,10 @@ const string cInvalidLevel = "Invalid level";
 
 const string cGenerativeModelTypeId = "ae82c484-a137-4a86-beef-441b75ed9096";
 
+// Version 2 adds a checksum at the end of each section
+const int cGenerativeModelChecksumVersion = 2;
+const int cGenerativeModelVersion = 2;
+
 class TrainedModel {
 public:
     TrainedModel(): _separator(csSeparator), _period(cPeriod), _dataFileExtension(cDataFileExtension), _indexFileExtension(cIndexFileExtension) {
@@ -62,11 +66,11 @@ public:
         outFile.write((char *)dataVector.data(), size);
         outFile.close();
     }
-    void write(ofstream& os) {
+    void write(OutStream& os) {
         InOut::Write(os, _dataVector);
         InOut::Write(os, _indexVector);
     }
-    void read(ifstream& is) {
+    void read(InStream& is) {
         InOut::Read(is, _dataVector);
         InOut::Read(is, _indexVector);
     }
@@ -90,12 +94,14 @@ public:
     }
     GenerativeModel(DataSource& dataSource): _typeId(cGenerativeModelTypeId), _version(1), _numberOfTrainingIterations(0), _numberOfInitializationIterations(0), _numberOfHiddenLayerUnits(), _learningRate(), _dropout(0), _dataSource(dataSource) {
     }
-    void writeWithReadingTrainedModel(ofstream& os, const string& modelName, int version = 1) {
+    void writeWithReadingTrainedModel(OutStream& os, const string& modelName, int version = cGenerativeModelVersion) {
         _trainedModel.readVectors(modelName);
         
         write(os, modelName, version);
     }
-    void write(ofstream& os, const string& modelName, int version = 1, int numberOfIterations = 0) {
+    void write(OutStream& os, const string& modelName, int version = cGenerativeModelVersion, int numberOfIterations = 0) {
+        bool checksums = version >= cGenerativeModelChecksumVersion;
+        os.setChecksums(checksums);
         InOut::Write(os, _typeId);
         InOut::Write(os, version);
         
@@ -105,27 +111,35 @@ public:
         InOut::Write(os, _numberOfHiddenLayerUnits);
         InOut::Write(os, _learningRate);
         InOut::Write(os, _dropout);
+        os.endSection();
         
         _dataSource.write(os);
         
+        os.setChecksums(checksums);
         _trainedModel.write(os);
+        os.endSection();
     }
-    void read(ifstream& is, const string& modelName) {
+    void read(InStream& is, const string& modelName) {
         InOut::Read(is, _typeId);
         if(_typeId != cGenerativeModelTypeId) {
             throw string(cInvalidTypeId);
         }
         InOut::Read(is, _version);
+        bool checksums = _version >= cGenerativeModelChecksumVersion;
+        is.setChecksums(checksums);
         
         InOut::Read(is, _numberOfTrainingIterations);
         InOut::Read(is, _numberOfInitializationIterations);
         InOut::Read(is, _numberOfHiddenLayerUnits);
         InOut::Read(is, _learningRate);
         InOut::Read(is, _dropout);
+        is.endSection();
 
         _dataSource.read(is);
 
+        is.setChecksums(checksums);
         _trainedModel.read(is);
+        is.endSection();
         
         _trainedModel.writeVectors(modelName);
     }
@@ -7,189 +7,499 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+
+#include "crc32c.h"
+#include "utf8.h"
+#include "codec.h"
+#include "pagedVector.h"
 
 using namespace std;
 
 //const string cSeparator = "_";
 //const string cPeriod = ".";
 
-class InOut {
+// Number of bytes converted per chunk when byte order has to be swapped
+const size_t cBlockBufferSize = 1 << 20;
+const size_t cDefaultStreamBufferSize = 1 << 22;
+
+const string cFileTruncated = "File is truncated";
+const string cFileCorrupt = "Checksum mismatch, file is corrupt";
+const string cFileWriteFailed = "File could not be written";
+const string cInvalidSize = "Invalid size in file";
+
+// Buffered binary output file. Written bytes are accumulated in a checksum
+// that is appended to the file and restarted when a section is ended.
+class OutStream {
 public:
-	static void Write(ofstream& os, const bool& x) {
-		os.write((const char *)&x, sizeof(x));
+	OutStream(size_t bufferSize = cDefaultStreamBufferSize): _buffer(max(bufferSize, (size_t)1)), _position(0), _checksums(true), _blocks(false), _compression(false) {
 	}
-	static 	void Read(ifstream& is, const bool& x) {
-		is.read((char *)&x, sizeof(x));
+	~OutStream() {
+		try {
+			close();
+		} catch(...) {
+			;
+		}
 	}
 
-	static void Write(ofstream& os, const unsigned char& x) {
-		os.write((const char *)&x, sizeof(x));
+	void open(const string& fileName) {
+		_os.rdbuf()->pubsetbuf(0, 0);
+		_os.open(fileName.c_str(), ios::binary);
+		_position = 0;
+		_crc.reset();
 	}
-	static void Read(ifstream& is, const unsigned char& x) {
-		is.read((char *)&x, sizeof(x));
+	bool isOpen() const {
+		return _os.is_open();
+	}
+	void close() {
+		if(_os.is_open()) {
+			flush();
+			_os.close();
+		}
 	}
 
-	static void Write(ofstream& os, const int& x) {
-		os.write((const char *)&x, sizeof(x));
+	void write(const char* p, size_t size) {
+		_crc.update(p, size);
+		put(p, size);
+	}
+	void setChecksums(bool checksums) {
+		_checksums = checksums;
+	}
+	void setBlocks(bool blocks) {
+		_blocks = blocks;
 	}
-	static void Read(ifstream& is, const int& x) {
-		is.read((char *)&x, sizeof(x));
+	bool getBlocks() const {
+		return _blocks;
+	}
+	void setCompression(bool compression) {
+		_compression = compression;
+	}
+	bool getCompression() const {
+		return _compression;
+	}
+	void endSection() {
+		if(_checksums) {
+			uint32_t crc = _crc.get();
+			unsigned char c[4] = {(unsigned char)crc, (unsigned char)(crc >> 8), (unsigned char)(crc >> 16), (unsigned char)(crc >> 24)};
+			put((const char *)c, sizeof(c));
+		}
+		_crc.reset();
+	}
+	void flush() {
+		if(_position > 0) {
+			_os.write(_buffer.data(), _position);
+			_position = 0;
+		}
+		if(!_os) {
+			throw string(cFileWriteFailed);
+		}
 	}
 
-	static void Write(ofstream& os, const float& x) {
-		os.write((const char *)&x, sizeof(x));
+private:
+	void put(const char* p, size_t size) {
+		if(_position + size > _buffer.size()) {
+			flush();
+		}
+		if(size >= _buffer.size()) {
+			_os.write(p, size);
+			if(!_os) {
+				throw string(cFileWriteFailed);
+			}
+			return;
+		}
+		memcpy(_buffer.data() + _position, p, size);
+		_position += size;
 	}
-	static void Read(ifstream& is, const float& x) {
-		is.read((char *)&x, sizeof(x));
+
+	ofstream _os;
+	vector<char> _buffer;
+	size_t _position;
+	bool _checksums;
+	bool _blocks;
+	bool _compression;
+	Crc32c _crc;
+};
+
+// Buffered binary input file. When checksums are enabled the checksum stored
+// at the end of each section is verified against the bytes read.
+class InStream {
+public:
+	InStream(size_t bufferSize = cDefaultStreamBufferSize): _buffer(max(bufferSize, (size_t)1)), _position(0), _end(0), _remaining(0), _checksums(false), _wideStrings(false), _blocks(false) {
 	}
 
-	static void Write(ofstream& os, const char* p, size_t size) {
-    if(size > 0) {
-      os.write((const char *)p, sizeof(char) * size);
-    }
-  }
-	static void Read(ifstream& is, const char* p, size_t size) {
-    if(size > 0) {
-      is.read((char *)p, sizeof(char) * size);
-    }
-  }
+	void open(const string& fileName) {
+		_is.rdbuf()->pubsetbuf(0, 0);
+		_is.open(fileName.c_str(), ios::binary | ios::ate);
+		_position = 0;
+		_end = 0;
+		_remaining = 0;
+		_crc.reset();
+		if(_is.is_open()) {
+			_remaining = (size_t)_is.tellg();
+			_is.seekg(0, ios::beg);
+		}
+	}
+	bool isOpen() const {
+		return _is.is_open();
+	}
+	void close() {
+		_is.close();
+	}
 
-	static void Write(ofstream& os, const wchar_t* p, size_t size) {
-		if(size > 0) {
-			os.write((const char *)p, sizeof(wchar_t) * size);
+	void read(char* p, size_t size) {
+		get(p, size);
+		_crc.update(p, size);
+	}
+	size_t getRemaining() const {
+		return _remaining;
+	}
+	void setChecksums(bool checksums) {
+		_checksums = checksums;
+	}
+	bool getChecksums() const {
+		return _checksums;
+	}
+	void setWideStrings(bool wideStrings) {
+		_wideStrings = wideStrings;
+	}
+	bool getWideStrings() const {
+		return _wideStrings;
+	}
+	void setBlocks(bool blocks) {
+		_blocks = blocks;
+	}
+	bool getBlocks() const {
+		return _blocks;
+	}
+	void endSection() {
+		if(_checksums) {
+			unsigned char c[4];
+			get((char *)c, sizeof(c));
+			uint32_t crc = (uint32_t)c[0] | (uint32_t)c[1] << 8 | (uint32_t)c[2] << 16 | (uint32_t)c[3] << 24;
+			if(crc != _crc.get()) {
+				throw string(cFileCorrupt);
+			}
 		}
+		_crc.reset();
 	}
-	static void Read(ifstream& is, const wchar_t* p, size_t size) {
+
+private:
+	void get(char* p, size_t size) {
+		if(size > _remaining) {
+			throw string(cFileTruncated);
+		}
+		_remaining -= size;
+
+		size_t n = min(size, _end - _position);
+		memcpy(p, _buffer.data() + _position, n);
+		_position += n;
+		p += n;
+		size -= n;
+
+		if(size >= _buffer.size()) {
+			_is.read(p, size);
+			if((size_t)_is.gcount() != size) {
+				throw string(cFileTruncated);
+			}
+			return;
+		}
 		if(size > 0) {
-			is.read((char *)p, sizeof(wchar_t) * size);
+			_is.read(_buffer.data(), _buffer.size());
+			_end = _is.gcount();
+			_is.clear();
+			if(_end < size) {
+				throw string(cFileTruncated);
+			}
+			memcpy(p, _buffer.data(), size);
+			_position = size;
 		}
 	}
 
-	static void Write(ofstream& os, const string& x) {
-    int size = x.size();
-    Write(os, size);
-    Write(os, x.c_str(), size);
-  }
-	static void Read(ifstream& is, string& x) {
-    int size = 0;
-    Read(is, size);
-    x.resize(size);
-    Read(is, x.c_str(), size);
-  }
+	ifstream _is;
+	vector<char> _buffer;
+	size_t _position;
+	size_t _end;
+	size_t _remaining;
+	bool _checksums;
+	bool _wideStrings;
+	bool _blocks;
+	Crc32c _crc;
+};
 
-	static void Write(ofstream& os, const wstring& x) {
-		int size = x.size();
-		Write(os, size);
-		Write(os, x.c_str(), size);
+class InOut {
+public:
+	// Files are written in little-endian byte order. On little-endian hosts
+	// blocks are transferred with a single call, on big-endian hosts they are
+	// swapped in chunks of cBlockBufferSize bytes.
+	static bool IsLittleEndian() {
+		const uint16_t x = 1;
+		return *((const unsigned char *)&x) == 1;
 	}
-	static void Read(ifstream& is, wstring& x) {
-		int size = 0;
-		Read(is, size);
-		x.resize(size);
-		Read(is, x.c_str(), size);
+
+	template<class T> static void WriteBlock(OutStream& os, const T* p, size_t size) {
+		if(size == 0) {
+			return;
+		}
+		if(sizeof(T) == 1 || IsLittleEndian()) {
+			os.write((const char *)p, sizeof(T) * size);
+			return;
+		}
+
+		size_t n = max((size_t)1, cBlockBufferSize / sizeof(T));
+		vector<char> buffer(sizeof(T) * min(n, size));
+		for(size_t i = 0; i < size; i += n) {
+			size_t m = min(n, size - i);
+			const char* q = (const char *)(p + i);
+			for(size_t j = 0; j < m; j++) {
+				reverse_copy(q + j * sizeof(T), q + (j + 1) * sizeof(T), buffer.data() + j * sizeof(T));
+			}
+			os.write(buffer.data(), sizeof(T) * m);
+		}
 	}
+	template<class T> static void ReadBlock(InStream& is, T* p, size_t size) {
+		if(size == 0) {
+			return;
+		}
+		is.read((char *)p, sizeof(T) * size);
+		if(sizeof(T) == 1 || IsLittleEndian()) {
+			return;
+		}
 
-	static void Write(ofstream& os, const vector<unsigned char>& x) {
-		int size = x.size();
-		Write(os, size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Write(os, x[i]);
+		char* q = (char *)p;
+		for(size_t j = 0; j < size; j++) {
+			reverse(q + j * sizeof(T), q + (j + 1) * sizeof(T));
 		}
 	}
-	static void Read(ifstream& is, vector<unsigned char>& x) {
-		int size = 0;
-		Read(is, size);
-		x.resize(size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Read(is, x[i]);
+
+	// Vectors of 32-bit elements are framed in blocks of cCodecBlockSize
+	// elements when blocks are enabled. Each block is stored with its codec
+	// and encoded size, compressing codecs are only tried when compression
+	// is enabled.
+	template<class T> static void WriteBlocks(OutStream& os, const T* p, size_t size) {
+		static_assert(sizeof(T) == sizeof(uint32_t), "32-bit elements expected");
+		BlockCodec codec;
+		vector<unsigned char> buffer;
+		for(size_t i = 0; i < size; i += cCodecBlockSize) {
+			int n = min((size_t)cCodecBlockSize, size - i);
+			unsigned char c = codec.encode(p + i, n, os.getCompression(), buffer);
+			int encodedSize = buffer.size();
+			Write(os, c);
+			Write(os, encodedSize);
+			WriteBlock(os, buffer.data(), buffer.size());
+		}
+	}
+	template<class T> static void ReadBlocks(InStream& is, T* p, size_t size) {
+		static_assert(sizeof(T) == sizeof(uint32_t), "32-bit elements expected");
+		BlockCodec codec;
+		vector<unsigned char> buffer;
+		for(size_t i = 0; i < size; i += cCodecBlockSize) {
+			int n = min((size_t)cCodecBlockSize, size - i);
+			unsigned char c = 0;
+			Read(is, c);
+			int encodedSize = ReadSize(is, sizeof(unsigned char));
+			buffer.resize(encodedSize);
+			ReadBlock(is, buffer.data(), buffer.size());
+			codec.decode(c, buffer.data(), buffer.size(), p + i, n);
 		}
 	}
 
-	static void Write(ofstream& os, const vector<int>& x) {
+	// Vectors of 32-bit values with the layout of vector<int> and vector<float>
+	template<class V> static void WriteValues(OutStream& os, const V& x) {
 		int size = x.size();
 		Write(os, size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Write(os, x[i]);
+		if(os.getBlocks()) {
+			WriteBlocks(os, x.data(), x.size());
+		} else {
+			WriteBlock(os, x.data(), x.size());
+		}
+	}
+	template<class V> static void ReadValues(InStream& is, V& x) {
+		if(is.getBlocks()) {
+			int size = ReadBlocksSize(is);
+			x.resize(size);
+			ReadBlocks(is, x.data(), x.size());
+		} else {
+			int size = ReadSize(is, sizeof(typename V::value_type));
+			x.resize(size);
+			ReadBlock(is, x.data(), x.size());
 		}
 	}
-	static void Read(ifstream& is, vector<int>& x) {
+
+	static int ReadBlocksSize(InStream& is) {
+		int size = ReadSize(is, 0);
+		size_t blockCount = ((size_t)size + cCodecBlockSize - 1) / cCodecBlockSize;
+		if(blockCount * (sizeof(unsigned char) + sizeof(int)) > is.getRemaining()) {
+			throw string(cFileTruncated);
+		}
+		return size;
+	}
+
+	static int ReadSize(InStream& is, size_t elementSize) {
 		int size = 0;
 		Read(is, size);
+		if(size < 0) {
+			throw string(cInvalidSize);
+		}
+		if((size_t)size * elementSize > is.getRemaining()) {
+			throw string(cFileTruncated);
+		}
+		return size;
+	}
+
+	static void Write(OutStream& os, const bool& x) {
+		WriteBlock(os, &x, 1);
+	}
+	static 	void Read(InStream& is, const bool& x) {
+		ReadBlock(is, (bool *)&x, 1);
+	}
+
+	static void Write(OutStream& os, const unsigned char& x) {
+		WriteBlock(os, &x, 1);
+	}
+	static void Read(InStream& is, const unsigned char& x) {
+		ReadBlock(is, (unsigned char *)&x, 1);
+	}
+
+	static void Write(OutStream& os, const int& x) {
+		WriteBlock(os, &x, 1);
+	}
+	static void Read(InStream& is, const int& x) {
+		ReadBlock(is, (int *)&x, 1);
+	}
+
+	static void Write(OutStream& os, const float& x) {
+		WriteBlock(os, &x, 1);
+	}
+	static void Read(InStream& is, const float& x) {
+		ReadBlock(is, (float *)&x, 1);
+	}
+
+	static void Write(OutStream& os, const char* p, size_t size) {
+		WriteBlock(os, p, size);
+	}
+	static void Read(InStream& is, const char* p, size_t size) {
+		ReadBlock(is, (char *)p, size);
+	}
+
+	static void Read(InStream& is, const wchar_t* p, size_t size) {
+		ReadBlock(is, (wchar_t *)p, size);
+	}
+
+	static void Write(OutStream& os, const string& x) {
+    int size = x.size();
+    Write(os, size);
+    Write(os, x.c_str(), size);
+  }
+	static void Read(InStream& is, string& x) {
+    int size = ReadSize(is, sizeof(char));
+    x.resize(size);
+    Read(is, x.c_str(), size);
+  }
+
+	static void Read(InStream& is, wstring& x) {
+		int size = ReadSize(is, sizeof(wchar_t));
 		x.resize(size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Read(is, x[i]);
+		Read(is, x.c_str(), size);
+	}
+
+	// Text is stored as UTF-8. Files of older versions contain text as raw
+	// wchar_t sequences, these are converted when wide strings are enabled.
+	static void ReadText(InStream& is, string& x) {
+		if(is.getWideStrings()) {
+			wstring w;
+			Read(is, w);
+			x = ToUtf8()(w);
+		} else {
+			Read(is, x);
 		}
 	}
 
-	static void Write(ofstream& os, const vector<float>& x) {
+	static void Write(OutStream& os, const vector<unsigned char>& x) {
 		int size = x.size();
 		Write(os, size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Write(os, x[i]);
-		}
+		WriteBlock(os, x.data(), x.size());
 	}
-	static void Read(ifstream& is, vector<float>& x) {
-		int size = 0;
-		Read(is, size);
+	static void Read(InStream& is, vector<unsigned char>& x) {
+		int size = ReadSize(is, sizeof(unsigned char));
 		x.resize(size);
-		for(int i = 0; i < (int)x.size(); i++) {
-			Read(is, x[i]);
-		}
+		ReadBlock(is, x.data(), x.size());
 	}
 
-	static void Write(ofstream& os, const vector<wstring>& x) {
+	static void Write(OutStream& os, const vector<int>& x) {
+		WriteValues(os, x);
+	}
+	static void Read(InStream& is, vector<int>& x) {
+		ReadValues(is, x);
+	}
+
+	static void Write(OutStream& os, const vector<float>& x) {
+		WriteValues(os, x);
+	}
+	static void Read(InStream& is, vector<float>& x) {
+		ReadValues(is, x);
+	}
+
+	// Paged values are decoded block by block into the page file
+	template<class T> static void Write(OutStream& os, const PagedVector<T>& x) {
+		WriteValues(os, x);
+	}
+	template<class T> static void Read(InStream& is, PagedVector<T>& x) {
+		ReadValues(is, x);
+	}
+
+	static void Write(OutStream& os, const vector<string>& x) {
 		int size = x.size();
 		Write(os, size);
 		for(int i = 0; i < (int)x.size(); i++) {
 			Write(os, x[i]);
 		}
 	}
-	static void Read(ifstream& is, vector<wstring>& x) {
-		int size = 0;
-		Read(is, size);
+	static void Read(InStream& is, vector<string>& x) {
+		int size = ReadSize(is, sizeof(int));
 		x.resize(size);
 		for(int i = 0; i < (int)x.size(); i++) {
-			Read(is, x[i]);
+			ReadText(is, x[i]);
 		}
 	}
 
-	static void Write(ofstream& os, const map<wstring, int>& x) {
+	static void Write(OutStream& os, const map<string, int>& x) {
 		int size = x.size();
 		Write(os, size);
-		map<wstring, int>::const_iterator iter(x.begin());
+		map<string, int>::const_iterator iter(x.begin());
 		while(iter != x.end()) {
 			Write(os, iter->first);
 			Write(os, iter->second);
 			iter++;
 		}
 	}
-	static void Read(ifstream& is, map<wstring, int>& x) {
-		int size = x.size();
-		Read(is, size);
-		wstring k;
+	static void Read(InStream& is, map<string, int>& x) {
+		int size = ReadSize(is, sizeof(int));
+		string k;
 		for(int i = 0; i < (int)size; i++) {
-			Read(is, k);
+			ReadText(is, k);
 			Read(is, x[k]);
 		}
 	}
 
-	static void Write(ofstream& os, const map<int, wstring>& x) {
+	static void Write(OutStream& os, const map<int, string>& x) {
 		int size = x.size();
 		Write(os, size);
-		map<int, wstring>::const_iterator iter(x.begin());
+		map<int, string>::const_iterator iter(x.begin());
 		while(iter != x.end()) {
 			Write(os, iter->first);
 			Write(os, iter->second);
 			iter++;
 		}
 	}
-	static void Read(ifstream& is, map<int, wstring>& x) {
-		int size = x.size();
-		Read(is, size);
+	static void Read(InStream& is, map<int, string>& x) {
+		int size = ReadSize(is, sizeof(int));
 		int k = 0;
 		for(int i = 0; i < (int)size; i++) {
 			Read(is, k);
-			Read(is, x[k]);
+			ReadText(is, x[k]);
 		}
 	}
 };
@@ -0,0 +1,116 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef KNN_GRAPH
+#define KNN_GRAPH
+
+#include <vector>
+#include <climits>
+
+#include "inOut.h"
+
+using namespace std;
+
+const string cKnnGraphTooLarge = "Nearest neighbor graph too large";
+const string cInvalidKnnGraph = "Invalid nearest neighbor graph";
+
+// Graph of the k nearest neighbors of all rows in compressed sparse row
+// layout. The neighbors of row i are at the positions offsets[i] to
+// offsets[i + 1] - 1 of the index and distance vectors in ascending order
+// of distance. As in density searches a row is its own nearest neighbor.
+// The graph is valid for rows of the dimension it was built for as long
+// as no rows are added.
+class KnnGraph {
+public:
+    KnnGraph(): _k(0), _dimension(0) {
+    }
+
+    void clear() {
+        _k = 0;
+        _dimension = 0;
+        vector<int>().swap(_offsets);
+        vector<int>().swap(_indices);
+        vector<float>().swap(_distances);
+    }
+    // Allocate size rows of neighborCount neighbors for k nearest neighbors
+    void resize(int size, int k, int neighborCount, int dimension) {
+        if((long long)size * neighborCount > INT_MAX) {
+            throw string(cKnnGraphTooLarge);
+        }
+        _k = k;
+        _dimension = dimension;
+        _offsets.resize(size + 1);
+        for(int i = 0; i <= size; i++) {
+            _offsets[i] = i * neighborCount;
+        }
+        _indices.assign((size_t)size * neighborCount, 0);
+        _distances.assign((size_t)size * neighborCount, 0);
+    }
+
+    bool isEmpty() const {
+        return _offsets.empty();
+    }
+    int getK() const {
+        return _k;
+    }
+    int getDimension() const {
+        return _dimension;
+    }
+    int getSize() const {
+        return _offsets.empty() ? 0 : _offsets.size() - 1;
+    }
+    int getNeighborCount(int i) const {
+        return _offsets[i + 1] - _offsets[i];
+    }
+    int* getIndices(int i) {
+        return _indices.data() + _offsets[i];
+    }
+    const int* getIndices(int i) const {
+        return _indices.data() + _offsets[i];
+    }
+    float* getDistances(int i) {
+        return _distances.data() + _offsets[i];
+    }
+    const float* getDistances(int i) const {
+        return _distances.data() + _offsets[i];
+    }
+
+    void write(OutStream& os) {
+        InOut::Write(os, _k);
+        InOut::Write(os, _dimension);
+        InOut::Write(os, _offsets);
+        InOut::Write(os, _indices);
+        InOut::Write(os, _distances);
+    }
+    void read(InStream& is) {
+        InOut::Read(is, _k);
+        InOut::Read(is, _dimension);
+        InOut::Read(is, _offsets);
+        InOut::Read(is, _indices);
+        InOut::Read(is, _distances);
+        if(_offsets.size() == 1 || _indices.size() != _distances.size() ||
+           (!_offsets.empty() && (_offsets.front() != 0 || _offsets.back() != (int)_indices.size()))) {
+            throw string(cInvalidKnnGraph);
+        }
+        for(int i = 0; i + 1 < (int)_offsets.size(); i++) {
+            if(_offsets[i] > _offsets[i + 1]) {
+                throw string(cInvalidKnnGraph);
+            }
+        }
+        int size = getSize();
+        for(int index : _indices) {
+            if(index < 0 || index >= size) {
+                throw string(cInvalidKnnGraph);
+            }
+        }
+    }
+
+private:
+    int _k;
+    int _dimension;
+    vector<int> _offsets;
+    vector<int> _indices;
+    vector<float> _distances;
+};
+
+#endif
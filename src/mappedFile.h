@@ -0,0 +1,102 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef MAPPED_FILE
+#define MAPPED_FILE
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Read-only view of a whole file. The file is memory mapped where mmap is
+// available, otherwise it is read into a buffer.
+class MappedFile {
+public:
+    MappedFile(): _pData(0), _size(0), _mapped(false) {
+    }
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const string& fileName) {
+        close();
+#ifndef _WIN32
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        _size = st.st_size;
+        if(_size > 0) {
+            void* p = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED) {
+                madvise(p, _size, MADV_SEQUENTIAL);
+                _pData = (const char *)p;
+                _mapped = true;
+            }
+        }
+        ::close(fd);
+        if(_size == 0 || _mapped) {
+            return true;
+        }
+#endif
+        ifstream is(fileName.c_str(), ios::binary | ios::ate);
+        if(!is.is_open()) {
+            return false;
+        }
+        _size = (size_t)is.tellg();
+        _buffer.resize(_size);
+        is.seekg(0, ios::beg);
+        is.read(_buffer.data(), _size);
+        if((size_t)is.gcount() != _size) {
+            _buffer.clear();
+            _size = 0;
+            return false;
+        }
+        _pData = _buffer.data();
+        return true;
+    }
+    void close() {
+#ifndef _WIN32
+        if(_mapped) {
+            munmap((void *)_pData, _size);
+        }
+#endif
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+        _pData = 0;
+        _size = 0;
+        _mapped = false;
+    }
+
+    const char* getData() const {
+        return _pData;
+    }
+    size_t getSize() const {
+        return _size;
+    }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* _pData;
+    size_t _size;
+    bool _mapped;
+    vector<char> _buffer;
+};
+
+#endif
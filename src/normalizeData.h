@@ -144,6 +144,37 @@ public:
         }
         return normalizedNumberVector;
     }
+    // Normalize rowCount unnormalized records given column-major in p into
+    // rows of q, which must hold rowCount * dataSource.getDimension() values
+    void getNormalizedNumberMatrix(DataSource& dataSource, const double* p, int rowCount, int dimension, float* q) {
+        if(dataSource.getDimension() != dimension) {
+            throw string(cInvalidDimension);
+        }
+
+        int j = 0;
+        vector<Column*>& columnVector = dataSource.getColumnVector();
+        for(int i = 0; i < (int)columnVector.size(); i++) {
+            if(columnVector[i]->getActive()) {
+                Column::COLUMN_TYPE type = columnVector[i]->getColumnType();
+                if(type == Column::NUMERICAL) {
+                    const double* column = p + (size_t)j * rowCount;
+                    for(int k = 0; k < rowCount; k++) {
+                        q[(size_t)k * dimension + j] = getNormalizedNumber(columnVector[i], (float)column[k]);
+                    }
+                    j++;
+                } else if(type == Column::NUMERICAL_ARRAY) {
+                    for(int l = 0; l < columnVector[i]->getDimension(); l++, j++) {
+                        const double* column = p + (size_t)j * rowCount;
+                        for(int k = 0; k < rowCount; k++) {
+                            q[(size_t)k * dimension + j] = (float)column[k];
+                        }
+                    }
+                } else{
+                    throw string(cInvalidColumnType);
+                }
+            }
+        }
+    }
     float getNormalizedNumber(Column* pColumn, float number, bool limit = false) {
         if(isnan(number)) {
             return number;    
@@ -12,10 +12,10 @@ public:
     NumberArrayColumn(const COLUMN_TYPE& type, int size):Column(type, BINARY) {
          _numberColumnArray.resize(size, NumberColumn(NUMERICAL));
     }
-    NumberArrayColumn(const COLUMN_TYPE& type, const wstring& name, int size): Column(type, BINARY, name, true) {
+    NumberArrayColumn(const COLUMN_TYPE& type, const string& name, int size): Column(type, BINARY, name, true) {
          _numberColumnArray.resize(size, NumberColumn(NUMERICAL));
     }
-    NumberArrayColumn(const COLUMN_TYPE& type, const SCALE_TYPE& scaleType, const wstring& name, bool active, int size): Column(type, scaleType, name, active) {
+    NumberArrayColumn(const COLUMN_TYPE& type, const SCALE_TYPE& scaleType, const string& name, bool active, int size): Column(type, scaleType, name, active) {
         _numberColumnArray.resize(size, NumberColumn(NUMERICAL));
     }
     NumberArrayColumn(const NumberArrayColumn& numberArrayColumn): Column(numberArrayColumn.getColumnType(), numberArrayColumn.getScaleType(), numberArrayColumn.getName(), numberArrayColumn.getActive()) {
@@ -26,7 +26,7 @@ public:
         _numberColumnArray.clear();
     }
 
-    void setColumnNames(const vector<wstring> columnNames) {
+    void setColumnNames(const vector<string> columnNames) {
         for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
             _numberColumnArray[i].setName(columnNames[i]);
         }
@@ -46,6 +46,22 @@ public:
             _numberColumnArray[i].addNormalizedValue(valueVector[offset + i]);
         }
     }
+    virtual void addNormalizedValues(const double* p, int rowCount, const int* indices, int rowStride, int dimensionStride) {
+        for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
+            _numberColumnArray[i].addNormalizedValues(p + (size_t)i * dimensionStride, rowCount, indices, rowStride, dimensionStride);
+        }
+    }
+    virtual void reserveNormalized(int size) {
+        for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
+            _numberColumnArray[i].reserveNormalized(size);
+        }
+    }
+    virtual void setPageDirectory(const string& pageDirectory) {
+        _pageDirectory = pageDirectory;
+        for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
+            _numberColumnArray[i].setPageDirectory(pageDirectory);
+        }
+    }
     virtual vector<float> getNumberVector(int i) {
         if(i < 0 || i > (getSize() - 1)) {
             throw cInvalidIndex;
@@ -117,7 +133,7 @@ public:
         return min;
     }
     
-    wstring getMaxValue(int i) {
+    string getMaxValue(int i) {
         vector<float> numberVector = getNormalizedNumberVector(i);
         float max = 0;
         int index = -1;
@@ -135,7 +151,7 @@ public:
         }
     }
     
-    wstring getMaxValue(vector<float>& numberVector) {
+    string getMaxValue(vector<float>& numberVector) {
         float max = 0;
         int index = -1;
         for(int j = 0; j < (int) numberVector.size(); j++) {
@@ -152,7 +168,7 @@ public:
         }
     }
     
-    virtual void write(ofstream& os) {
+    virtual void write(OutStream& os) {
         Column::write(os);
         InOut::Write(os, _valueMap);
         
@@ -163,7 +179,7 @@ public:
         }
     }
     
-    virtual void read(ifstream& is) {
+    virtual void read(InStream& is) {
         Column::read(is);
         InOut::Read(is, _valueMap);
         
@@ -171,24 +187,25 @@ public:
         InOut::Read(is, size);
         _numberColumnArray.resize(size);
         for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
+            _numberColumnArray[i].setPageDirectory(_pageDirectory);
             _numberColumnArray[i].read(is);
         }
     }
     
-    map<wstring, int> const & getValueMap() const {
+    map<string, int> const & getValueMap() const {
         return _valueMap;
     }
     
     void setValueMap() {
         for(int i = 0; i < (int)_numberColumnArray.size(); i++) {
-            wstring name = _numberColumnArray[i].getName();
+            string name = _numberColumnArray[i].getName();
             _valueMap[name] = i;
         }
     }
     
-    virtual vector<float> getNormalizedNumberVector(wstring value) {
+    virtual vector<float> getNormalizedNumberVector(string value) {
         vector<float> numberVector(_numberColumnArray.size(), 0);
-        map<wstring, int>::const_iterator valueMapIter;
+        map<string, int>::const_iterator valueMapIter;
         valueMapIter = _valueMap.find(value);
         if(valueMapIter != _valueMap.end()) {
             numberVector[valueMapIter->second] = 1;
@@ -198,8 +215,9 @@ public:
     }
     
 private:
-    map<wstring, int> _valueMap;
+    map<string, int> _valueMap;
     vector<NumberColumn> _numberColumnArray;
+    string _pageDirectory;
 };
 
 #endif
@@ -21,9 +21,9 @@ public:
 	}
  	NumberColumn(const COLUMN_TYPE type):Column(type, LINEAR), _max(0), _min(0) {
 	}
-	NumberColumn(const COLUMN_TYPE type, const wstring& name): Column(type, LINEAR, name, true), _max(0), _min(0) {
+	NumberColumn(const COLUMN_TYPE type, const string& name): Column(type, LINEAR, name, true), _max(0), _min(0) {
 	}
-    NumberColumn(const COLUMN_TYPE type, const SCALE_TYPE scaleType, const wstring& name): Column(type, scaleType, name, true), _max(0), _min(0) {
+    NumberColumn(const COLUMN_TYPE type, const SCALE_TYPE scaleType, const string& name): Column(type, scaleType, name, true), _max(0), _min(0) {
     }
 	NumberColumn(const NumberColumn& numberColumn):Column(numberColumn.getColumnType(), numberColumn.getScaleType(), numberColumn.getName(), numberColumn.getActive()), _max(numberColumn.getMax()), _min(numberColumn.getMin()) {
 	}
@@ -42,6 +42,22 @@ public:
 	}
     virtual void addNormalizedValue(float value) {
         _normalizedValueVector.push_back(value);
+    }
+	template<class T> void addValues(const T* p, int size) {
+		_valueVector.append(p, p + size);
+	}
+    virtual void addNormalizedValues(const double* p, int rowCount, const int* indices, int rowStride, int dimensionStride) {
+        for(int i = 0; i < rowCount; i++) {
+            int row = indices != 0 ? indices[i] : i;
+            _normalizedValueVector.push_back(p[(size_t)row * rowStride]);
+        }
+    }
+    virtual void reserveNormalized(int size) {
+        _normalizedValueVector.reserve(size);
+    }
+    virtual void setPageDirectory(const string& pageDirectory) {
+        _valueVector.setPageDirectory(pageDirectory);
+        _normalizedValueVector.setPageDirectory(pageDirectory);
     }
 	virtual vector<float> getNumberVector(int i) {
 		if(i < 0 || i > ((int)_valueVector.size() - 1)) {
@@ -69,6 +85,12 @@ public:
 	    }
 		return numberVector;
 	}
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride) {
+		getNormalizedValues(indexVector, p, [this]() { return _uniformRealDistribution(); });
+	}
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride, Philox& generator) {
+		getNormalizedValues(indexVector, p, [&generator]() { return (float)(generator() >> 8) * (1.0f / 16777216.0f); });
+	}
     virtual vector<float> getDenormalizedNumberVector(int i) {
         if(i < 0 || i > ((int)_normalizedValueVector.size() - 1)) {
             throw string(cInvalidIndex);
@@ -105,14 +127,14 @@ public:
         return 1;
     }
   
-	vector<float>& getValueVector() {
+	PagedVector<float>& getValueVector() {
 	    return _valueVector;
 	}
-	vector<float>& getNormalizedValueVector() {
+	PagedVector<float>& getNormalizedValueVector() {
 		return _normalizedValueVector;
 	}
 
-	virtual void write(ofstream& os) {
+	virtual void write(OutStream& os) {
 		Column::write(os);
 	  
 		InOut::Write(os, _max);
@@ -120,7 +142,7 @@ public:
 		InOut::Write(os, _valueVector);
 		InOut::Write(os, _normalizedValueVector);
 	}
-	virtual void read(ifstream& is) {
+	virtual void read(InStream& is) {
 		Column::read(is);
 	  
 		InOut::Read(is, _max);
@@ -130,10 +152,29 @@ public:
 	}
 
 private:
+	// Normalized values of the rows in indexVector, missing values are
+	// replaced by impute()
+	template<class F> void getNormalizedValues(const vector<int>& indexVector, double* p, F impute) {
+		if(_scaleType != LINEAR) {
+			throw cInvalidScaleType;
+		}
+		for(int i = 0; i < (int)indexVector.size(); i++) {
+			int index = indexVector[i];
+			if(index < 0 || index > ((int)_normalizedValueVector.size() - 1)) {
+				throw string(cInvalidIndex);
+			}
+			float value = _normalizedValueVector[index];
+			if(isnan(value)) {
+				value = impute();
+			}
+			p[i] = value;
+		}
+	}
+
     float _max;
 	float _min;
-	vector<float> _valueVector;
-	vector<float> _normalizedValueVector;
+	PagedVector<float> _valueVector;
+	PagedVector<float> _normalizedValueVector;
 	
 	UniformRealDistribution _uniformRealDistribution;
 };
@@ -0,0 +1,187 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef OUTLIER_SCORES
+#define OUTLIER_SCORES
+
+#include "dataSource.h"
+#include "vpTree.h"
+#include "normalizeData.h"
+#include "parallel.h"
+#include "density.h"
+
+const float cOutlierScoreEpsilon = 1e-10;
+
+// Outlier scores of rows and of records from their k nearest neighbors among
+// the rows. As for density values a row is its own nearest neighbor, so a
+// record equal to a row gets the score of the row. The k nearest neighbor
+// distance is the distance to the k-th nearest neighbor. The local outlier
+// factor is the mean local reachability density of the nearest neighbors
+// divided by the local reachability density of the row or record, which is
+// the inverse of the mean reachability distance max(k-distance(o), d(p, o))
+// to its nearest neighbors o. Local outlier factors around 1 denote inliers,
+// larger values outliers. Nearest neighbors of rows are taken from the graph
+// of the data source if it holds enough neighbors, otherwise they are
+// searched in the tree. Searches run in blocks on numberOfThreads threads.
+class OutlierScores {
+public:
+    OutlierScores(DataSource& dataSource, VpTree* vpTree, int nNearestNeighbors, int numberOfThreads = 0) : _dataSource(dataSource), _vpTree(vpTree), _nNearestNeighbors(nNearestNeighbors), _parallelFor(numberOfThreads) {
+        if(nNearestNeighbors <= 0) {
+            throw string(cInvalidNearestNeighbors);
+        }
+    }
+
+    vector<float> calculateKNearestNeighborDistances() {
+        const KnnGraph& knnGraph = getKnnGraph();
+        vector<float> distances(knnGraph.getSize());
+        for(int i = 0; i < (int)distances.size(); i++) {
+            distances[i] = getKDistance(knnGraph, i);
+        }
+        return distances;
+    }
+
+    vector<float> calculateLocalOutlierFactors() {
+        const KnnGraph& knnGraph = getKnnGraph();
+        vector<float> localReachabilityDensities;
+        calculateLocalReachabilityDensities(knnGraph, localReachabilityDensities);
+        vector<float> localOutlierFactors(knnGraph.getSize());
+        parallelForRows(knnGraph.getSize(), [&](int i) {
+            localOutlierFactors[i] = getLocalOutlierFactor(knnGraph, i, localReachabilityDensities[i], localReachabilityDensities);
+        });
+        return localOutlierFactors;
+    }
+
+    // Scores of rowCount unnormalized records given column-major in p
+    vector<float> calculateKNearestNeighborDistances(const double* p, int rowCount) {
+        KnnGraph recordGraph;
+        searchRecords(p, rowCount, recordGraph);
+        vector<float> distances(rowCount);
+        for(int i = 0; i < rowCount; i++) {
+            distances[i] = getKDistance(recordGraph, i);
+        }
+        return distances;
+    }
+
+    vector<float> calculateLocalOutlierFactors(const double* p, int rowCount) {
+        KnnGraph recordGraph;
+        searchRecords(p, rowCount, recordGraph);
+        const KnnGraph& knnGraph = getKnnGraph();
+        vector<float> localReachabilityDensities;
+        calculateLocalReachabilityDensities(knnGraph, localReachabilityDensities);
+        vector<float> localOutlierFactors(rowCount);
+        parallelForRows(rowCount, [&](int i) {
+            float localReachabilityDensity = getLocalReachabilityDensity(recordGraph, i, _kDistances);
+            localOutlierFactors[i] = getLocalOutlierFactor(recordGraph, i, localReachabilityDensity, localReachabilityDensities);
+        });
+        return localOutlierFactors;
+    }
+
+private:
+    // Graph of the rows of the data source or, without one for enough
+    // nearest neighbors, a graph searched in the tree
+    const KnnGraph& getKnnGraph() {
+        if(_dataSource.hasKnnGraph(_nNearestNeighbors)) {
+            return _dataSource.getKnnGraph();
+        }
+        if(_knnGraph.isEmpty()) {
+            int n = _dataSource.getNormalizedSize();
+            search(n, [&](int i) {
+                return _dataSource.getNormalizedRowData(i);
+            }, _knnGraph);
+        }
+        return _knnGraph;
+    }
+
+    void searchRecords(const double* p, int rowCount, KnnGraph& recordGraph) {
+        int dimension = _dataSource.getDimension();
+        vector<float> normalizedRows((size_t)rowCount * dimension);
+        NormalizeData normalizeData;
+        normalizeData.getNormalizedNumberMatrix(_dataSource, p, rowCount, dimension, normalizedRows.data());
+        search(rowCount, [&](int i) {
+            return (const float*)normalizedRows.data() + (size_t)i * dimension;
+        }, recordGraph);
+    }
+
+    // Search the nearest neighbors of size targets into a graph
+    template<class F> void search(int size, F target, KnnGraph& knnGraph) {
+        int n = _dataSource.getNormalizedSize();
+        bool built = _vpTree->isBuilt();
+        knnGraph.resize(size, _nNearestNeighbors, min(_nNearestNeighbors, n), _dataSource.getDimension());
+        parallelForRows(size, [&](int i) {
+            vector<VpElement> nearestNeighbors;
+            if(built) {
+                _vpTree->search(target(i), _nNearestNeighbors, nearestNeighbors);
+            } else {
+                _vpTree->linearSearch(target(i), _nNearestNeighbors, nearestNeighbors);
+            }
+            int* indices = knnGraph.getIndices(i);
+            float* distances = knnGraph.getDistances(i);
+            for(int j = 0; j < knnGraph.getNeighborCount(i); j++) {
+                indices[j] = nearestNeighbors[j].getIndex();
+                distances[j] = nearestNeighbors[j].getDistance();
+            }
+        });
+    }
+
+    // Execute f(i) for i = 0, ..., size - 1 in blocks of cDensityBlockSize rows
+    template<class F> void parallelForRows(int size, F f) {
+        _parallelFor((size + cDensityBlockSize - 1) / cDensityBlockSize, [&](int b) {
+            int end = min(size, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                f(i);
+            }
+        });
+    }
+
+    int getNeighborCount(const KnnGraph& knnGraph, int i) const {
+        return min(_nNearestNeighbors, knnGraph.getNeighborCount(i));
+    }
+
+    float getKDistance(const KnnGraph& knnGraph, int i) const {
+        int count = getNeighborCount(knnGraph, i);
+        return count > 0 ? knnGraph.getDistances(i)[count - 1] : 0;
+    }
+
+    // k-distances and local reachability densities of all rows
+    void calculateLocalReachabilityDensities(const KnnGraph& knnGraph, vector<float>& localReachabilityDensities) {
+        int n = knnGraph.getSize();
+        _kDistances.resize(n);
+        for(int i = 0; i < n; i++) {
+            _kDistances[i] = getKDistance(knnGraph, i);
+        }
+        localReachabilityDensities.resize(n);
+        parallelForRows(n, [&](int i) {
+            localReachabilityDensities[i] = getLocalReachabilityDensity(knnGraph, i, _kDistances);
+        });
+    }
+
+    float getLocalReachabilityDensity(const KnnGraph& knnGraph, int i, const vector<float>& kDistances) const {
+        int count = getNeighborCount(knnGraph, i);
+        const int* indices = knnGraph.getIndices(i);
+        const float* distances = knnGraph.getDistances(i);
+        double sum = 0;
+        for(int j = 0; j < count; j++) {
+            sum += max(kDistances[indices[j]], distances[j]);
+        }
+        return count > 0 ? 1 / (sum / count + cOutlierScoreEpsilon) : 0;
+    }
+
+    float getLocalOutlierFactor(const KnnGraph& knnGraph, int i, float localReachabilityDensity, const vector<float>& localReachabilityDensities) const {
+        int count = getNeighborCount(knnGraph, i);
+        const int* indices = knnGraph.getIndices(i);
+        double sum = 0;
+        for(int j = 0; j < count; j++) {
+            sum += localReachabilityDensities[indices[j]];
+        }
+        return count > 0 ? sum / count / localReachabilityDensity : 0;
+    }
+
+    DataSource& _dataSource;
+    VpTree* _vpTree;
+    int _nNearestNeighbors;
+    ParallelFor _parallelFor;
+    KnnGraph _knnGraph;
+    vector<float> _kDistances;
+};
+
+#endif
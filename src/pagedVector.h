@@ -0,0 +1,217 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef PAGED_VECTOR
+#define PAGED_VECTOR
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const size_t cPagedVectorMinCapacity = 1024;
+
+const string cPageFileError = "Page file could not be created in";
+
+// Contiguous values kept in memory or, when a page directory is set, in an
+// unlinked temporary file of that directory mapped into memory. Pages of a
+// mapped file are written back and evicted by the operating system, so the
+// resident size is bounded by the page cache instead of the number of
+// values. Without mmap values are always kept in memory. T has to be
+// trivially copyable. Clearing releases the storage.
+template<class T> class PagedVector {
+public:
+    typedef T value_type;
+
+    PagedVector(): _size(0), _capacity(0), _pData(0), _fd(-1), _mappedSize(0) {
+    }
+    PagedVector(const PagedVector& pagedVector): _pageDirectory(pagedVector._pageDirectory), _size(0), _capacity(0), _pData(0), _fd(-1), _mappedSize(0) {
+        append(pagedVector.begin(), pagedVector.end());
+    }
+    ~PagedVector() {
+        release();
+    }
+    // Values are copied, the page directory is kept
+    PagedVector& operator=(const PagedVector& pagedVector) {
+        if(this != &pagedVector) {
+            _size = 0;
+            append(pagedVector.begin(), pagedVector.end());
+        }
+        return *this;
+    }
+
+    // Set the directory of the page file, empty for values in memory. Values
+    // are moved to the new storage.
+    void setPageDirectory(const string& pageDirectory) {
+        if(pageDirectory == _pageDirectory) {
+            return;
+        }
+        PagedVector pagedVector;
+        pagedVector._pageDirectory = pageDirectory;
+        pagedVector.append(begin(), end());
+        swap(pagedVector);
+    }
+    const string& getPageDirectory() const {
+        return _pageDirectory;
+    }
+    bool isPaged() const {
+        return _fd >= 0;
+    }
+
+    void swap(PagedVector& pagedVector) {
+        std::swap(_pageDirectory, pagedVector._pageDirectory);
+        std::swap(_size, pagedVector._size);
+        std::swap(_capacity, pagedVector._capacity);
+        std::swap(_pData, pagedVector._pData);
+        _memory.swap(pagedVector._memory);
+        std::swap(_fd, pagedVector._fd);
+        std::swap(_mappedSize, pagedVector._mappedSize);
+    }
+    void clear() {
+        release();
+    }
+    void reserve(size_t capacity) {
+        if(capacity <= _capacity) {
+            return;
+        }
+#ifndef _WIN32
+        if(!_pageDirectory.empty()) {
+            mapFile(capacity * sizeof(T));
+            _capacity = capacity;
+            return;
+        }
+#endif
+        _memory.resize(capacity);
+        _pData = _memory.data();
+        _capacity = capacity;
+    }
+    void resize(size_t size, const T& value = T()) {
+        reserve(size);
+        if(size > _size) {
+            fill(_pData + _size, _pData + size, value);
+        }
+        _size = size;
+    }
+    void assign(size_t size, const T& value) {
+        _size = 0;
+        resize(size, value);
+    }
+    void push_back(const T& value) {
+        if(_size == _capacity) {
+            T v = value;
+            reserve(max(2 * _capacity, cPagedVectorMinCapacity));
+            _pData[_size++] = v;
+            return;
+        }
+        _pData[_size++] = value;
+    }
+    template<class I> void append(I first, I last) {
+        size_t n = distance(first, last);
+        if(_size + n > _capacity) {
+            reserve(max(_size + n, 2 * _capacity));
+        }
+        copy(first, last, _pData + _size);
+        _size += n;
+    }
+
+    T& operator[](size_t i) {
+        return _pData[i];
+    }
+    const T& operator[](size_t i) const {
+        return _pData[i];
+    }
+    T& back() {
+        return _pData[_size - 1];
+    }
+    T* data() {
+        return _pData;
+    }
+    const T* data() const {
+        return _pData;
+    }
+    T* begin() {
+        return _pData;
+    }
+    T* end() {
+        return _pData + _size;
+    }
+    const T* begin() const {
+        return _pData;
+    }
+    const T* end() const {
+        return _pData + _size;
+    }
+    size_t size() const {
+        return _size;
+    }
+    bool empty() const {
+        return _size == 0;
+    }
+
+private:
+#ifndef _WIN32
+    void mapFile(size_t mappedSize) {
+        if(_fd < 0) {
+            string fileName = _pageDirectory + "/gdPageXXXXXX";
+            vector<char> name(fileName.begin(), fileName.end());
+            name.push_back(0);
+            _fd = mkstemp(name.data());
+            if(_fd < 0) {
+                throw string(cPageFileError + " " + _pageDirectory);
+            }
+            unlink(name.data());
+        }
+        if(_pData != 0) {
+            munmap(_pData, _mappedSize);
+            _pData = 0;
+            _mappedSize = 0;
+        }
+        if(mappedSize == 0) {
+            return;
+        }
+        if(ftruncate(_fd, mappedSize) != 0) {
+            throw string(cPageFileError + " " + _pageDirectory);
+        }
+        void* p = mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if(p == MAP_FAILED) {
+            throw string(cPageFileError + " " + _pageDirectory);
+        }
+        _pData = (T *)p;
+        _mappedSize = mappedSize;
+    }
+#endif
+    void release() {
+#ifndef _WIN32
+        if(_fd >= 0) {
+            if(_pData != 0) {
+                munmap(_pData, _mappedSize);
+            }
+            ::close(_fd);
+        }
+#endif
+        vector<T>().swap(_memory);
+        _pData = 0;
+        _fd = -1;
+        _mappedSize = 0;
+        _size = 0;
+        _capacity = 0;
+    }
+
+    string _pageDirectory;
+    size_t _size;
+    size_t _capacity;
+    T* _pData;
+    vector<T> _memory;
+    int _fd;
+    size_t _mappedSize;
+};
+
+#endif
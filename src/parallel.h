@@ -0,0 +1,89 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+// Execute f(i) for i = 0, ..., n - 1 on up to numberOfThreads threads, by
+// default one per hardware thread. Tasks are taken in ascending order, the
+// first exception thrown by a task is rethrown after all threads finished.
+// Tasks must not call into R.
+class ParallelFor {
+public:
+    ParallelFor(int numberOfThreads = 0): _numberOfThreads(numberOfThreads) {
+        if(_numberOfThreads <= 0) {
+            _numberOfThreads = max(1, (int)thread::hardware_concurrency());
+        }
+    }
+
+    int getNumberOfThreads() const {
+        return _numberOfThreads;
+    }
+
+    void operator()(int n, const function<void(int)>& f) {
+        int numberOfThreads = min(_numberOfThreads, n);
+        if(numberOfThreads <= 1) {
+            for(int i = 0; i < n; i++) {
+                f(i);
+            }
+            return;
+        }
+
+        atomic<int> next(0);
+        mutex errorMutex;
+        string error;
+        bool failed = false;
+        auto run = [&]() {
+            while(true) {
+                int i = next++;
+                if(i >= n) {
+                    return;
+                }
+                try {
+                    f(i);
+                } catch(const string& e) {
+                    lock_guard<mutex> lock(errorMutex);
+                    if(!failed) {
+                        failed = true;
+                        error = e;
+                    }
+                    next = n;
+                } catch(...) {
+                    lock_guard<mutex> lock(errorMutex);
+                    if(!failed) {
+                        failed = true;
+                        error = "C++ exception (unknown reason)";
+                    }
+                    next = n;
+                }
+            }
+        };
+
+        vector<thread> threads;
+        for(int t = 1; t < numberOfThreads; t++) {
+            threads.push_back(thread(run));
+        }
+        run();
+        for(auto& t : threads) {
+            t.join();
+        }
+        if(failed) {
+            throw error;
+        }
+    }
+
+private:
+    int _numberOfThreads;
+};
+
+#endif
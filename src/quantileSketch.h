@@ -0,0 +1,234 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef QUANTILE_SKETCH
+#define QUANTILE_SKETCH
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#include "inOut.h"
+#include "rng.h"
+
+using namespace std;
+
+const int cSketchK = 200;
+const uint64_t cSketchSeed = 0x6b6c6c;
+
+const string cInvalidSketch = "Invalid quantile sketch";
+
+// KLL quantile sketch. Values are kept in levels, a value of level h stands
+// for 2^h values. A level exceeding its capacity is sorted and every second
+// value, starting at a random offset, is promoted to the next level, so
+// total weight is preserved. Capacities decrease by 2/3 per level below the
+// top level, the sketch keeps O(k) values and the rank error is about
+// 1.7 / k with high probability. Sketches with the same k can be merged, so
+// shards or threads can be summarized separately. NaN values are ignored.
+// Offsets are drawn from a fixed seed, so sketches are reproducible and do
+// not take streams of the global generator.
+class QuantileSketch {
+public:
+    QuantileSketch(int k = cSketchK): _k(max(k, 8)), _size(0), _generator(cSketchSeed) {
+    }
+
+    void clear() {
+        _levels.clear();
+        _size = 0;
+    }
+    void update(float value) {
+        if(isnan(value)) {
+            return;
+        }
+        if(_levels.empty()) {
+            _levels.resize(1);
+        }
+        _levels[0].push_back(value);
+        _size++;
+        if(_size >= getMaxSize()) {
+            compress();
+        }
+    }
+    void merge(const QuantileSketch& quantileSketch) {
+        if(quantileSketch._k != _k) {
+            throw string(cInvalidSketch);
+        }
+        if(_levels.size() < quantileSketch._levels.size()) {
+            _levels.resize(quantileSketch._levels.size());
+        }
+        for(int h = 0; h < (int)quantileSketch._levels.size(); h++) {
+            _levels[h].insert(_levels[h].end(), quantileSketch._levels[h].begin(), quantileSketch._levels[h].end());
+        }
+        _size += quantileSketch._size;
+        while(_size >= getMaxSize()) {
+            compress();
+        }
+    }
+    // Apply a non-decreasing function to all values, ranks are unchanged
+    void transform(const function<float(float)>& f) {
+        for(auto& level : _levels) {
+            for(auto& value : level) {
+                value = f(value);
+            }
+        }
+    }
+
+    // Number of summarized values
+    double getCount() const {
+        double count = 0;
+        for(int h = 0; h < (int)_levels.size(); h++) {
+            count += ldexp((double)_levels[h].size(), h);
+        }
+        return count;
+    }
+    bool isEmpty() const {
+        return _size == 0;
+    }
+    int getK() const {
+        return _k;
+    }
+
+    // Approximate quantile with the selection rule of the exact quantile:
+    // the smallest value whose rank reaches floor(percent / 100 * count)
+    float getQuantile(float percent) const {
+        vector<pair<float, double> > weightedValues = getWeightedValues();
+        if(weightedValues.empty()) {
+            return 0;
+        }
+        double count = getCount();
+        double target = max(floor(percent / 100.0 * count), 1.0);
+        double rank = 0;
+        for(int i = 0; i < (int)weightedValues.size(); i++) {
+            rank += weightedValues[i].second;
+            if(rank >= target) {
+                return weightedValues[i].first;
+            }
+        }
+        return weightedValues.back().first;
+    }
+    // Approximate percentage of values less or equal to value
+    float getInverseQuantile(float value) const {
+        double count = getCount();
+        if(count == 0 || isnan(value)) {
+            return 0;
+        }
+        double rank = 0;
+        for(int h = 0; h < (int)_levels.size(); h++) {
+            double weight = ldexp(1.0, h);
+            for(float v : _levels[h]) {
+                if(v <= value) {
+                    rank += weight;
+                }
+            }
+        }
+        return rank / count * 100;
+    }
+
+    void write(OutStream& os) {
+        InOut::Write(os, _k);
+        int size = _levels.size();
+        InOut::Write(os, size);
+        for(int h = 0; h < size; h++) {
+            InOut::Write(os, _levels[h]);
+        }
+    }
+    void read(InStream& is) {
+        InOut::Read(is, _k);
+        if(_k < 8) {
+            throw string(cInvalidSketch);
+        }
+        int size = InOut::ReadSize(is, sizeof(int));
+        _levels.assign(size, vector<float>());
+        _size = 0;
+        for(int h = 0; h < size; h++) {
+            InOut::Read(is, _levels[h]);
+            _size += _levels[h].size();
+        }
+    }
+
+private:
+    int getCapacity(int h) const {
+        int depth = _levels.size() - 1 - h;
+        return max(2, (int)ceil(_k * pow(2.0 / 3.0, depth)));
+    }
+    int getMaxSize() const {
+        int maxSize = 0;
+        for(int h = 0; h < (int)_levels.size(); h++) {
+            maxSize += getCapacity(h);
+        }
+        return maxSize;
+    }
+    void compress() {
+        for(int h = 0; h < (int)_levels.size(); h++) {
+            if((int)_levels[h].size() < getCapacity(h)) {
+                continue;
+            }
+            if(h + 1 == (int)_levels.size()) {
+                _levels.resize(_levels.size() + 1);
+            }
+            vector<float>& level = _levels[h];
+            vector<float>& nextLevel = _levels[h + 1];
+            sort(level.begin(), level.end());
+            int n = level.size() & ~1;
+            for(int i = _generator() & 1; i < n; i += 2) {
+                nextLevel.push_back(level[i]);
+            }
+            _size -= n / 2;
+            level.erase(level.begin(), level.begin() + n);
+            return;
+        }
+    }
+    vector<pair<float, double> > getWeightedValues() const {
+        vector<pair<float, double> > weightedValues;
+        weightedValues.reserve(_size);
+        for(int h = 0; h < (int)_levels.size(); h++) {
+            double weight = ldexp(1.0, h);
+            for(float v : _levels[h]) {
+                weightedValues.push_back(make_pair(v, weight));
+            }
+        }
+        sort(weightedValues.begin(), weightedValues.end());
+        return weightedValues;
+    }
+
+    int _k;
+    int _size;
+    vector<vector<float> > _levels;
+    Philox _generator;
+};
+
+// Sketch of values of consecutive blocks, e.g. the blocks of a ParallelFor.
+// The sketch of each block is built on its thread and merged in block order,
+// a block finished early is kept until all blocks before it are merged, so
+// the merged sketch does not depend on the number of threads or their timing.
+// Every block has to be added.
+class BlockQuantileSketch {
+public:
+    BlockQuantileSketch(int k = cSketchK): _quantileSketch(k), _next(0) {
+    }
+
+    void add(int block, const QuantileSketch& quantileSketch) {
+        lock_guard<mutex> lock(_mutex);
+        _pending.insert(make_pair(block, quantileSketch));
+        map<int, QuantileSketch>::iterator it;
+        while((it = _pending.find(_next)) != _pending.end()) {
+            _quantileSketch.merge(it->second);
+            _pending.erase(it);
+            _next++;
+        }
+    }
+    QuantileSketch& getQuantileSketch() {
+        return _quantileSketch;
+    }
+
+private:
+    QuantileSketch _quantileSketch;
+    map<int, QuantileSketch> _pending;
+    int _next;
+    mutex _mutex;
+};
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef REPRESENTATIVES
+#define REPRESENTATIVES
+
+#include <queue>
+#include <cfloat>
+
+#include "dataSource.h"
+#include "vpTree.h"
+#include "parallel.h"
+#include "density.h"
+
+const float cRepresentativeMinRadius = 1e-10;
+
+const string cInvalidRepresentativeSize = "Invalid number of representatives";
+
+// Selection of representative rows covering the distribution of the rows
+// with density weighted farthest point sampling. The next representative is
+// the row with the largest distance to its nearest representative relative
+// to its k-th nearest neighbor radius. As the radius is proportional to
+// density^(-1 / dimension), representatives are spaced more densely in dense
+// regions and their number in a region is about proportional to the number
+// of rows in it, while sparse regions are still covered. Nearest neighbor
+// radii are taken from the graph of the data source if it holds enough
+// nearest neighbors, otherwise they are searched in parallel. Distances to
+// the nearest representative are updated with range searches bounded by the
+// largest distance still possible, so later steps touch few rows.
+class Representatives {
+public:
+    Representatives(DataSource& dataSource, VpTree* vpTree, int nNearestNeighbors, int numberOfThreads = 0) : _dataSource(dataSource), _vpTree(vpTree), _nNearestNeighbors(nNearestNeighbors), _parallelFor(numberOfThreads) {
+        if(nNearestNeighbors <= 0) {
+            throw string(cInvalidNearestNeighbors);
+        }
+    }
+
+    // Indices of size representatives in ascending order. weights receives
+    // the number of rows nearest to each representative. The tree has to be
+    // built.
+    vector<int> select(int size, vector<int>& weights) {
+        int n = _dataSource.getNormalizedSize();
+        if(size <= 0) {
+            throw string(cInvalidRepresentativeSize);
+        }
+        size = min(size, n);
+        weights.clear();
+        if(size == 0) {
+            return vector<int>();
+        }
+
+        vector<float> radii = getRadii();
+        float maxRadius = *max_element(radii.begin(), radii.end());
+        int dimension = _dataSource.getDimension();
+        L2Distance l2Distance;
+
+        // The first representative is the row of highest density
+        int first = min_element(radii.begin(), radii.end()) - radii.begin();
+        vector<float> distances(n);
+        vector<int> nearest(n, first);
+        const float* firstRow = _dataSource.getNormalizedRowData(first);
+        int blockCount = (n + cDensityBlockSize - 1) / cDensityBlockSize;
+        _parallelFor(blockCount, [&](int b) {
+            int end = min(n, (b + 1) * cDensityBlockSize);
+            for(int i = b * cDensityBlockSize; i < end; i++) {
+                distances[i] = l2Distance(_dataSource.getNormalizedRowData(i), firstRow, dimension);
+            }
+        });
+
+        // Scores only decrease, outdated entries of the queue are skipped
+        vector<pair<float, int> > scores(n);
+        for(int i = 0; i < n; i++) {
+            scores[i] = make_pair(distances[i] / radii[i], -i);
+        }
+        priority_queue<pair<float, int> > queue(less<pair<float, int> >(), move(scores));
+
+        vector<int> representatives(1, first);
+        vector<int> indices;
+        while((int)representatives.size() < size && !queue.empty()) {
+            pair<float, int> top = queue.top();
+            queue.pop();
+            int r = -top.second;
+            if(top.first != distances[r] / radii[r]) {
+                continue;
+            }
+            if(distances[r] == 0) {
+                break;
+            }
+            representatives.push_back(r);
+            distances[r] = 0;
+            nearest[r] = r;
+
+            float radius = min(top.first * maxRadius * (float)(1 + cDensityRadiusTolerance), FLT_MAX);
+            const float* row = _dataSource.getNormalizedRowData(r);
+            _vpTree->rangeSearch(row, radius, indices);
+            for(int i : indices) {
+                float d = l2Distance(_dataSource.getNormalizedRowData(i), row, dimension);
+                if(d < distances[i]) {
+                    distances[i] = d;
+                    nearest[i] = r;
+                    queue.push(make_pair(d / radii[i], -i));
+                }
+            }
+        }
+
+        sort(representatives.begin(), representatives.end());
+        vector<int> positions(n, -1);
+        for(int j = 0; j < (int)representatives.size(); j++) {
+            positions[representatives[j]] = j;
+        }
+        weights.assign(representatives.size(), 0);
+        for(int i = 0; i < n; i++) {
+            weights[positions[nearest[i]]]++;
+        }
+        return representatives;
+    }
+
+private:
+    // k-th nearest neighbor radii of all rows
+    vector<float> getRadii() {
+        KnnGraph searchedGraph;
+        const KnnGraph* pKnnGraph = &_dataSource.getKnnGraph();
+        if(!_dataSource.hasKnnGraph(_nNearestNeighbors)) {
+            Density density(_dataSource, _vpTree, _nNearestNeighbors, 0);
+            density.calculateKnnGraph(searchedGraph, _parallelFor.getNumberOfThreads());
+            pKnnGraph = &searchedGraph;
+        }
+        const KnnGraph& knnGraph = *pKnnGraph;
+
+        vector<float> radii(knnGraph.getSize(), cRepresentativeMinRadius);
+        for(int i = 0; i < (int)radii.size(); i++) {
+            int count = min(_nNearestNeighbors, knnGraph.getNeighborCount(i));
+            if(count > 0) {
+                radii[i] = max(knnGraph.getDistances(i)[count - 1], cRepresentativeMinRadius);
+            }
+        }
+        return radii;
+    }
+
+    DataSource& _dataSource;
+    VpTree* _vpTree;
+    int _nNearestNeighbors;
+    ParallelFor _parallelFor;
+};
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef RNG
+#define RNG
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <random>
+#include <utility>
+
+using namespace std;
+
+// Philox4x32-10 counter-based generator. A generator is defined by a key,
+// the seed, and a stream id, each output block of four words is a function
+// of key, stream and block counter only. Generators on different streams are
+// independent, so threads and tasks get their own streams and results do not
+// depend on scheduling. Satisfies the requirements of a uniform random bit
+// generator. The distributions of <random> and std::shuffle are
+// implementation defined, so bounded integers and shuffles are derived from
+// the output directly to get the same results on all standard libraries.
+class Philox {
+public:
+    typedef uint32_t result_type;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+    static constexpr result_type max() {
+        return 0xFFFFFFFF;
+    }
+
+    Philox(uint64_t seed = 0, uint64_t stream = 0) {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream = 0) {
+        _key = seed;
+        _stream = stream;
+        _counter = 0;
+        _index = 4;
+    }
+    uint64_t getSeed() const {
+        return _key;
+    }
+    uint64_t getStream() const {
+        return _stream;
+    }
+
+    result_type operator()() {
+        if(_index == 4) {
+            generate(_counter++, _buffer);
+            _index = 0;
+        }
+        return _buffer[_index++];
+    }
+    // Uniform integer in [0, n) for n > 0 with Lemire's multiply-shift
+    // method, biased products are rejected
+    uint32_t bounded(uint32_t n) {
+        uint64_t m = (uint64_t)operator()() * n;
+        if((uint32_t)m < n) {
+            uint32_t threshold = (0 - n) % n;
+            while((uint32_t)m < threshold) {
+                m = (uint64_t)operator()() * n;
+            }
+        }
+        return m >> 32;
+    }
+    // Fisher-Yates shuffle of the range [first, last)
+    template<class I> void shuffle(I first, I last) {
+        for(uint32_t i = last - first; i > 1; i--) {
+            swap(first[i - 1], first[bounded(i)]);
+        }
+    }
+
+    void discard(uint64_t n) {
+        while(n > 0 && _index < 4) {
+            _index++;
+            n--;
+        }
+        _counter += n / 4;
+        if(n % 4 != 0) {
+            generate(_counter++, _buffer);
+            _index = n % 4;
+        }
+    }
+    void fill(uint32_t* p, size_t n) {
+        while(n > 0 && _index < 4) {
+            *p++ = _buffer[_index++];
+            n--;
+        }
+        while(n >= 4) {
+            generate(_counter++, p);
+            p += 4;
+            n -= 4;
+        }
+        while(n > 0) {
+            *p++ = operator()();
+            n--;
+        }
+    }
+
+private:
+    void generate(uint64_t counter, uint32_t* out) const {
+        uint32_t c0 = (uint32_t)counter;
+        uint32_t c1 = (uint32_t)(counter >> 32);
+        uint32_t c2 = (uint32_t)_stream;
+        uint32_t c3 = (uint32_t)(_stream >> 32);
+        uint32_t k0 = (uint32_t)_key;
+        uint32_t k1 = (uint32_t)(_key >> 32);
+        for(int r = 0; r < 10; r++) {
+            uint64_t p0 = (uint64_t)0xD2511F53 * c0;
+            uint64_t p1 = (uint64_t)0xCD9E8D57 * c2;
+            uint32_t d0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            uint32_t d2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c1 = (uint32_t)p1;
+            c3 = (uint32_t)p0;
+            c0 = d0;
+            c2 = d2;
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    uint64_t _key;
+    uint64_t _stream;
+    uint64_t _counter;
+    uint32_t _buffer[4];
+    int _index;
+};
+
+// Global seed of all generators. Objects needing randomness take the next
+// stream, so after SetSeed every generator is reproducible. Computations
+// that should not depend on how many objects were created before them take
+// the stream of a fixed task id instead. Without SetSeed the seed is taken
+// from random_device.
+class Rng {
+public:
+    static void SetSeed(uint64_t seed) {
+        State& state = getState();
+        state.seed = seed;
+        state.stream = 0;
+    }
+    static Philox NextStream() {
+        State& state = getState();
+        return Philox(state.seed, state.stream++);
+    }
+    static Philox TaskStream(uint64_t task) {
+        return Philox(getState().seed, cTaskStreamBit | task);
+    }
+
+private:
+    static const uint64_t cTaskStreamBit = (uint64_t)1 << 63;
+
+    struct State {
+        State(): stream(0) {
+            random_device rd;
+            seed = (uint64_t)rd() << 32 | rd();
+        }
+        uint64_t seed;
+        atomic<uint64_t> stream;
+    };
+    static State& getState() {
+        static State state;
+        return state;
+    }
+};
+
+#endif
@@ -0,0 +1,90 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef ROW_MATRIX
+#define ROW_MATRIX
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "pagedVector.h"
+
+using namespace std;
+
+const int cRowMatrixMinCapacity = 1024;
+
+// Rows of equal dimension stored contiguously row by row in a PagedVector,
+// so rows are kept in a page file of the page directory when it is set.
+class RowMatrix {
+public:
+    RowMatrix(): _dimension(0), _size(0), _capacity(0) {
+    }
+
+    // Set the directory of the page file, empty for rows in memory. Clears the matrix.
+    void setPageDirectory(const string& pageDirectory) {
+        clear();
+        _values.setPageDirectory(pageDirectory);
+    }
+    const string& getPageDirectory() const {
+        return _values.getPageDirectory();
+    }
+    bool isPaged() const {
+        return _values.isPaged();
+    }
+
+    void clear() {
+        _values.clear();
+        _size = 0;
+        _capacity = 0;
+    }
+    // Resize to size rows of dimension values, new rows are zero
+    void resize(int size, int dimension) {
+        if(dimension != _dimension) {
+            clear();
+            _dimension = dimension;
+        }
+        reserve(size);
+        _values.resize((size_t)size * _dimension);
+        _size = size;
+    }
+    void reserve(int capacity) {
+        if(capacity <= _capacity) {
+            return;
+        }
+        _values.reserve((size_t)capacity * _dimension);
+        _capacity = capacity;
+    }
+    // Append a row of getDimension() values
+    template<class T> void addRow(const T* p) {
+        if(_size == _capacity) {
+            reserve(max(2 * _capacity, cRowMatrixMinCapacity));
+        }
+        _values.append(p, p + _dimension);
+        _size++;
+    }
+
+    float* operator[](int i) {
+        return _values.data() + (size_t)i * _dimension;
+    }
+    const float* operator[](int i) const {
+        return _values.data() + (size_t)i * _dimension;
+    }
+    int size() const {
+        return _size;
+    }
+    int getDimension() const {
+        return _dimension;
+    }
+
+private:
+    RowMatrix(const RowMatrix&);
+    RowMatrix& operator=(const RowMatrix&);
+
+    int _dimension;
+    int _size;
+    int _capacity;
+    PagedVector<float> _values;
+};
+
+#endif
@@ -9,7 +9,7 @@
 
 using namespace std;
 
-const wstring cNA = L"NA";
+const string cNA = "NA";
 
 const string cInvalidValue = "Invalid value";
 
@@ -17,7 +17,7 @@ class StringColumn : public Column{
 public:
 	StringColumn(const COLUMN_TYPE type): Column(type, NOMINAL) {
 	}
-	StringColumn(const COLUMN_TYPE type, const wstring& name): Column(type, NOMINAL, name, true){
+	StringColumn(const COLUMN_TYPE type, const string& name): Column(type, NOMINAL, name, true){
 	}
 	StringColumn(const StringColumn& stringColumn): Column(stringColumn.getColumnType(), stringColumn.getScaleType(), stringColumn.getName(), stringColumn.getActive()) {
 	    _valueMap = stringColumn.getValueMap();
@@ -30,9 +30,9 @@ public:
 	    _valueVector.clear();
 	}
 
-	virtual void addValue(const wstring& value, bool addNewValue = true) {
+	virtual void addValue(const string& value, bool addNewValue = true) {
 		int n = -1;
-		map<wstring, int>::iterator valueMapIterator = _valueMap.find(value);
+		map<string, int>::iterator valueMapIterator = _valueMap.find(value);
 		if(valueMapIterator != _valueMap.end()) {
 			n = valueMapIterator->second;
 		} else {
@@ -46,6 +46,22 @@ public:
 		}
 		_valueVector.push_back(n);
 	}
+	// Append size values given as 1-based codes into levels, invalid codes
+	// are added as NA. Each level is resolved once, in order of first
+	// appearance, so indices are the same as with addValue per value.
+	void addValues(const vector<string>& levels, const int* codes, int size) {
+		vector<int> indexVector(levels.size() + 1, -1);
+		_valueVector.reserve(_valueVector.size() + size);
+		for(int i = 0; i < size; i++) {
+			int code = codes[i] >= 1 && codes[i] <= (int)levels.size() ? codes[i] - 1 : levels.size();
+			if(indexVector[code] < 0) {
+				addValue(code < (int)levels.size() ? levels[code] : cNA);
+				indexVector[code] = _valueVector.back();
+			} else {
+				_valueVector.push_back(indexVector[code]);
+			}
+		}
+	}
 	virtual vector<float> getNumberVector(int i) {
 	    if(i < 0 || i > ((int)_valueVector.size() - 1)) {
 	        throw string(cInvalidIndex);
@@ -81,9 +97,19 @@ public:
 
 	    return numberVector;
 	}
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride) {
+	    getNormalizedValues(indexVector, p, stride, [this]() { return _uniformIntDistribution(); });
+	}
+	virtual void getNormalizedNumberMatrix(const vector<int>& indexVector, double* p, int stride, Philox& generator) {
+	    uint32_t size = _valueMap.size();
+	    getNormalizedValues(indexVector, p, stride, [&generator, size]() { return 1 + (int)generator.bounded(size); });
+	}
     virtual vector<float> getDenormalizedNumberVector(int i) {
         return  getDenormalizedNumberVector(i);
     }
+	virtual void setPageDirectory(const string& pageDirectory) {
+	    _valueVector.setPageDirectory(pageDirectory);
+	}
 	virtual int getDimension() const {
 		if(_scaleType == NOMINAL) {
 			return _valueMap.size();
@@ -92,28 +118,28 @@ public:
 		}
 	}
 	
-  	vector<int>& getValueVector() {
+  	PagedVector<int>& getValueVector() {
 	    return _valueVector;
 	}
-  	wstring getValue(int i) {
+  	string getValue(int i) {
   		if(i < 0 || i > (getSize() - 1)) {
   			throw cInvalidIndex;
   		}
 
   		if(_valueVector[i] == 0) {
-  			return L"";
+  			return "";
   		}
 
-  		map<int, wstring>::const_iterator iter = _inverseValueMap.find(_valueVector[i]);
+  		map<int, string>::const_iterator iter = _inverseValueMap.find(_valueVector[i]);
   		if(iter == _inverseValueMap.end()) {
   			throw string(cInvalidValue);
   		}
   		return iter->second;
   	}
-	map<wstring, int> const & getValueMap() const {
+	map<string, int> const & getValueMap() const {
 		return _valueMap;
 	}
-	map<int, wstring> const & getInverseValueMap() const {
+	map<int, string> const & getInverseValueMap() const {
 		return _inverseValueMap;
 	}
 	virtual int getSize() {
@@ -123,13 +149,13 @@ public:
 		return _valueVector.size();
 	}
   
-	virtual void write(ofstream& os) {
+	virtual void write(OutStream& os) {
 		Column::write(os);
 		InOut::Write(os, _valueMap);
 		InOut::Write(os, _inverseValueMap);
 		InOut::Write(os, _valueVector);
 	}
-	virtual void read(ifstream& is) {
+	virtual void read(InStream& is) {
 		Column::read(is);
 		InOut::Read(is, _valueMap);
 		InOut::Read(is, _inverseValueMap);
@@ -139,9 +165,32 @@ public:
 	}
     
 private:
-	map<wstring, int> _valueMap;
-	map<int, wstring> _inverseValueMap;
-	vector<int> _valueVector;
+	// One-hot values of the rows in indexVector, a missing value gets the
+	// category impute() in 1, ..., number of categories
+	template<class F> void getNormalizedValues(const vector<int>& indexVector, double* p, int stride, F impute) {
+	    if(_scaleType != NOMINAL) {
+	        throw string(cInvalidColumnType);
+	    }
+	    int dimension = _valueMap.size();
+	    for(int j = 0; j < dimension; j++) {
+	        fill(p + j * stride, p + j * stride + indexVector.size(), 0.0);
+	    }
+	    for(int i = 0; i < (int)indexVector.size(); i++) {
+	        int k = indexVector[i];
+	        if(k < 0 || k > ((int)_valueVector.size() - 1)) {
+	            throw string(cInvalidIndex);
+	        }
+	        int index = _valueVector[k] - 1;
+	        if(_valueVector[k] == 0) {
+	            index = impute() - 1;
+	        }
+	        p[index * stride + i] = 1;
+	    }
+	}
+
+	map<string, int> _valueMap;
+	map<int, string> _inverseValueMap;
+	PagedVector<int> _valueVector;
 	
 	UniformIntDistribution _uniformIntDistribution;
 };
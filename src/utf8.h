@@ -0,0 +1,126 @@
+// Copyright 2021 Werner Mueller
+// Released under the GPL (>= 2)
+
+#ifndef UTF8
+#define UTF8
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const unsigned int cReplacementCharacter = 0xFFFD;
+
+// Convert wide strings to UTF-8. Depending on the platform wchar_t holds
+// UTF-32 or UTF-16 code units, surrogate pairs are combined.
+class ToUtf8 {
+public:
+    string operator()(const wstring& w) {
+        string s;
+        s.reserve(w.size());
+        for(size_t i = 0; i < w.size(); i++) {
+            unsigned int c = (unsigned int)w[i];
+            if(sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDBFF && i + 1 < w.size()) {
+                unsigned int d = (unsigned int)w[i + 1];
+                if(d >= 0xDC00 && d <= 0xDFFF) {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (d - 0xDC00);
+                    i++;
+                }
+            }
+            append(s, c);
+        }
+        return s;
+    }
+    vector<string> operator()(const vector<wstring>& w) {
+        vector<string> s(w.size());
+        for(int i = 0; i < (int)w.size(); i++) {
+            s[i] = operator()(w[i]);
+        }
+        return s;
+    }
+
+private:
+    void append(string& s, unsigned int c) {
+        if((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) {
+            c = cReplacementCharacter;
+        }
+        if(c < 0x80) {
+            s += (char)c;
+        } else if(c < 0x800) {
+            s += (char)(0xC0 | (c >> 6));
+            s += (char)(0x80 | (c & 0x3F));
+        } else if(c < 0x10000) {
+            s += (char)(0xE0 | (c >> 12));
+            s += (char)(0x80 | ((c >> 6) & 0x3F));
+            s += (char)(0x80 | (c & 0x3F));
+        } else {
+            s += (char)(0xF0 | (c >> 18));
+            s += (char)(0x80 | ((c >> 12) & 0x3F));
+            s += (char)(0x80 | ((c >> 6) & 0x3F));
+            s += (char)(0x80 | (c & 0x3F));
+        }
+    }
+};
+
+// Convert UTF-8 to wide strings. Invalid sequences are replaced by U+FFFD.
+class FromUtf8 {
+public:
+    wstring operator()(const string& s) {
+        wstring w;
+        w.reserve(s.size());
+        size_t i = 0;
+        while(i < s.size()) {
+            unsigned int c = (unsigned char)s[i];
+            int n = 0;
+            if(c < 0x80) {
+                n = 0;
+            } else if((c & 0xE0) == 0xC0) {
+                c &= 0x1F;
+                n = 1;
+            } else if((c & 0xF0) == 0xE0) {
+                c &= 0x0F;
+                n = 2;
+            } else if((c & 0xF8) == 0xF0) {
+                c &= 0x07;
+                n = 3;
+            } else {
+                w += (wchar_t)cReplacementCharacter;
+                i++;
+                continue;
+            }
+
+            size_t j = i + 1;
+            for(; j < s.size() && j <= i + n; j++) {
+                unsigned int d = (unsigned char)s[j];
+                if((d & 0xC0) != 0x80) {
+                    break;
+                }
+                c = (c << 6) | (d & 0x3F);
+            }
+            if(j != i + n + 1) {
+                w += (wchar_t)cReplacementCharacter;
+                i = j;
+                continue;
+            }
+            i = j;
+
+            if(sizeof(wchar_t) == 2 && c >= 0x10000) {
+                c -= 0x10000;
+                w += (wchar_t)(0xD800 + (c >> 10));
+                w += (wchar_t)(0xDC00 + (c & 0x3FF));
+            } else {
+                w += (wchar_t)c;
+            }
+        }
+        return w;
+    }
+    vector<wstring> operator()(const vector<string>& s) {
+        vector<wstring> w(s.size());
+        for(int i = 0; i < (int)s.size(); i++) {
+            w[i] = operator()(s[i]);
+        }
+        return w;
+    }
+};
+
+#endif
@@ -6,6 +6,10 @@
 
 #include <iostream>
 #include <random>
+#include <unordered_set>
+#include <algorithm>
+
+#include "rng.h"
 
 using namespace std;
 
@@ -62,85 +66,127 @@ public:
 
 class UniformIntDistribution {
 public:
-    UniformIntDistribution(): _pG(new mt19937(random_device()())), _pR(0) {
+    UniformIntDistribution(): _g(Rng::NextStream()), _a(0), _b(0) {
+        ;
+    }
+    UniformIntDistribution(const UniformIntDistribution& uniformIntDistribution): _g(Rng::NextStream()), _a(uniformIntDistribution._a), _b(uniformIntDistribution._b) {
         ;
     }
-    ~UniformIntDistribution() {
-        delete _pR;
-        delete _pG;
+    UniformIntDistribution& operator=(const UniformIntDistribution& uniformIntDistribution) {
+        _a = uniformIntDistribution._a;
+        _b = uniformIntDistribution._b;
+        return *this;
     }
     UniformIntDistribution& setParameters(int a, int b) {
-        delete _pR;
-        _pR = new uniform_int_distribution<int>(a, b);
+        _a = a;
+        _b = b;
         return *this;
     }
     void seed(int i) {
-        _pG->seed(i);   
+        _g.seed(i);
+    }
+    void setGenerator(const Philox& g) {
+        _g = g;
     }
     int operator()() {
-        return (*_pR)(*_pG);
+        return _a + (int)_g.bounded((uint32_t)(_b - _a) + 1);
+    }
+    void fill(int* p, size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            p[i] = operator()();
+        }
     }
 private:
-    mt19937* _pG;
-    uniform_int_distribution<int>* _pR;
+    Philox _g;
+    int _a;
+    int _b;
 };
   
 class UniformRealDistribution {
 public:
-    UniformRealDistribution(): _pG(new mt19937(random_device()())), _pR(new uniform_real_distribution<float>(0, 1)) {
+    UniformRealDistribution(): _g(Rng::NextStream()), _a(0), _b(1) {
         ;
     }
-    UniformRealDistribution(const UniformRealDistribution& uniformRealDistribution): _pG(new mt19937(random_device()())), _pR(new uniform_real_distribution<float>(0, 1)) {
+    UniformRealDistribution(const Philox& g, float a, float b): _g(g), _a(a), _b(b) {
         ;
     }
-    ~UniformRealDistribution() {
-        delete _pR;
-        delete _pG;
+    UniformRealDistribution(const UniformRealDistribution& uniformRealDistribution): _g(Rng::NextStream()), _a(uniformRealDistribution._a), _b(uniformRealDistribution._b) {
+        ;
+    }
+    UniformRealDistribution& operator=(const UniformRealDistribution& uniformRealDistribution) {
+        _a = uniformRealDistribution._a;
+        _b = uniformRealDistribution._b;
+        return *this;
     }
     UniformRealDistribution& setParameters(float a, float b) {
-        delete _pR;
-        _pR = new uniform_real_distribution<float>(a, b);
+        _a = a;
+        _b = b;
         return *this;
     }
     void seed(int i) {
-        _pG->seed(i);   
+        _g.seed(i);
+    }
+    void setGenerator(const Philox& g) {
+        _g = g;
     }
     float operator()() {
-        return (*_pR)(*_pG);
+        return map(_g());
+    }
+    // Values are generated in bulk, 24 random bits per value
+    void fill(float* p, size_t n) {
+        uint32_t buffer[256];
+        for(size_t i = 0; i < n; i += 256) {
+            size_t m = min(n - i, (size_t)256);
+            _g.fill(buffer, m);
+            for(size_t j = 0; j < m; j++) {
+                p[i + j] = map(buffer[j]);
+            }
+        }
     }
 private:
-    mt19937* _pG;
-    uniform_real_distribution<float>* _pR;
+    float map(uint32_t x) const {
+        float value = _a + (_b - _a) * ((float)(x >> 8) * (1.0f / 16777216.0f));
+        return value < _b ? value : _a;
+    }
+
+    Philox _g;
+    float _a;
+    float _b;
 };
 
+// Random subset of percent of the indices 0, ..., size - 1 in ascending
+// order. Floyd's algorithm draws the subset in O(k) time and memory for k
+// selected indices, independent of size.
 class  RandomIndicesWithoutReplacement {
 public:
     RandomIndicesWithoutReplacement() {
         ; 
     }
     vector<int> operator()(int size, float percent, int seed = -1) {
-        vector<int> indices(size);
-        for(int i = 0; i < (int)indices.size(); i++) {
-            indices[i] = i;
-        }
-    
-        vector<int> randomIndices;
-        random_device rd;
-        mt19937 mt(rd());
-        if(seed > 0) {
-            mt.seed(seed);
-        }
-    
         int n = round((float)size * percent / 100);
-        for(int i = 0; i < n; i++) {
-            if(indices.size() > 0) {
-                uniform_int_distribution<int> uid(0, indices.size() - 1);
-                int r = uid(mt);
-                randomIndices.push_back(indices[r]);
-                indices[r] = indices[indices.size() - 1];
-                indices.resize(indices.size() - 1);
+        return select(size, n, seed);
+    }
+    // Random subset of n of the indices 0, ..., size - 1 in ascending order
+    vector<int> select(int size, int n, int seed = -1) {
+        Philox g = seed > 0 ? Philox(seed) : Rng::NextStream();
+        return select(size, n, g);
+    }
+    vector<int> select(int size, int n, Philox& g) {
+        n = max(0, min(n, size));
+
+        unordered_set<int> selected;
+        selected.reserve(n);
+        vector<int> randomIndices;
+        randomIndices.reserve(n);
+        for(int j = size - n; j < size; j++) {
+            int r = g.bounded(j + 1);
+            if(!selected.insert(r).second) {
+                r = j;
+                selected.insert(r);
             }
+            randomIndices.push_back(r);
         }
+        sort(randomIndices.begin(), randomIndices.end());
         return randomIndices;
     }
 };
@@ -28,17 +28,21 @@ struct LpDistance{
     LpDistance() {}
     virtual ~LpDistance() {
     }
-    virtual float operator()(const vector<float>& a, const vector<float>& b) = 0;
-    virtual LpDistance& assign(const LpDistance& lpDistance) = 0;
-};
-
-struct L1Distance : public LpDistance {
     float operator()(const vector<float>& a, const vector<float>& b) {
         if(a.size() != b.size()) {
             throw string(cDifferentSizes);
         }
+        return operator()(a.data(), b.data(), a.size());
+    }
+    virtual float operator()(const float* a, const float* b, int n) = 0;
+    virtual LpDistance& assign(const LpDistance& lpDistance) = 0;
+};
+
+struct L1Distance : public LpDistance {
+    using LpDistance::operator();
+    float operator()(const float* a, const float* b, int n) {
         float d = 0.0;
-        for(int i = 0; i < (int)a.size(); i++) {
+        for(int i = 0; i < n; i++) {
             d += abs(a[i] - b[i]);
         }
         return d;
@@ -50,12 +54,10 @@ struct L1Distance : public LpDistance {
 };
 
 struct L2Distance : public LpDistance {
-    float operator()(const vector<float>& a, const vector<float>& b) {
-        if(a.size() != b.size()) {
-            throw string(cDifferentSizes);
-        }
+    using LpDistance::operator();
+    float operator()(const float* a, const float* b, int n) {
         float d = 0.0;
-        for(int i = 0; i < (int)a.size(); i++) {
+        for(int i = 0; i < n; i++) {
             d += (a[i] - b[i]) * (a[i] - b[i]);
         }
         return sqrt(d);
@@ -67,12 +69,10 @@ struct L2Distance : public LpDistance {
 };
 
 struct L2DistanceNan : public LpDistance {
-    float operator()(const vector<float>& a, const vector<float>& b) {
-        if(a.size() != b.size()) {
-            throw string(cDifferentSizes);
-        }
+    using LpDistance::operator();
+    float operator()(const float* a, const float* b, int n) {
         float d = 0.0;
-        for(int i = 0; i < (int)a.size(); i++) {
+        for(int i = 0; i < n; i++) {
             if(isnan(a[i]) || isnan(b[i])) {
                 continue;
             }
@@ -91,12 +91,13 @@ struct L2DistanceNanIndexed : public LpDistance {
     }
     L2DistanceNanIndexed(const L2DistanceNanIndexed& l2DistanceNanIndexed): _distance(l2DistanceNanIndexed._distance) {
     }
-    float operator()(const vector<float>& a, const vector<float>& b) {
-        if(a.size() != _distance.size() || b.size() != _distance.size()) {
+    using LpDistance::operator();
+    float operator()(const float* a, const float* b, int n) {
+        if(n != (int)_distance.size()) {
             throw string(cDifferentSizes);
         }
         float d = 0.0;
-        for(int i = 0; i < (int)a.size(); i++) {
+        for(int i = 0; i < n; i++) {
             if(isnan(_distance[i])) {
                 continue;
             }
@@ -118,8 +119,9 @@ public:
     virtual ~VpTreeData() {
     }
 
-    virtual vector<float>& getNumberVector(int i) = 0;
+    virtual const float* getNumberVector(int i) = 0;
     virtual int getSize() = 0;
+    virtual int getDimension() = 0;
 };
 
 /*
@@ -149,36 +151,61 @@ public:
     VpGenerativeData(const VpGenerativeData& vpGenerativeData): _pDataSource(vpGenerativeData._pDataSource) {
     }
 
-    virtual vector<float>& getNumberVector(int i) {
-        return  _pDataSource->getNormalizedNumberVectorReference(i);
+    virtual const float* getNumberVector(int i) {
+        return  _pDataSource->getNormalizedRowData(i);
     }
     virtual int getSize() {
         return _pDataSource->getNormalizedSize();
     }
+    virtual int getDimension() {
+        return _pDataSource->getDimension();
+    }
+
+private:
+    DataSource* _pDataSource;
+};
+
+// Subset of the normalized rows of a data source, e.g. a reference sample
+class VpSubsetData : public VpTreeData {
+public:
+    VpSubsetData(DataSource& dataSource, const vector<int>& indexVector): _pDataSource(&dataSource), _indexVector(indexVector) {
+    }
+
+    virtual const float* getNumberVector(int i) {
+        return  _pDataSource->getNormalizedRowData(_indexVector[i]);
+    }
+    virtual int getSize() {
+        return _indexVector.size();
+    }
+    virtual int getDimension() {
+        return _pDataSource->getDimension();
+    }
 
 private:
     DataSource* _pDataSource;
+    vector<int> _indexVector;
 };
 
 struct Distance {
-    Distance(VpTreeData& vpTreeData, LpDistance& lpDistance): _vpTreeData(vpTreeData), _lpDistance(lpDistance) {}
+    Distance(VpTreeData& vpTreeData, LpDistance& lpDistance): _vpTreeData(vpTreeData), _lpDistance(lpDistance), _dimension(vpTreeData.getDimension()) {}
     float operator()(const int& a, const int& b) {
-        vector<float>& aNumberVector = _vpTreeData.getNumberVector(a);
-        vector<float>& bNumberVector = _vpTreeData.getNumberVector(b);
-        return _lpDistance(aNumberVector, bNumberVector);
+        const float* aNumberVector = _vpTreeData.getNumberVector(a);
+        const float* bNumberVector = _vpTreeData.getNumberVector(b);
+        return _lpDistance(aNumberVector, bNumberVector, _dimension);
     }
 
     VpTreeData& _vpTreeData;
     LpDistance& _lpDistance;
+    int _dimension;
 };
 
 struct VpDistance {
-    VpDistance(VpTreeData& vpTreeData, int index, LpDistance& lpDistance): _vpTreeData(vpTreeData), _index(index), _lpDistance(lpDistance) {}
+    VpDistance(VpTreeData& vpTreeData, int index, LpDistance& lpDistance): _vpTreeData(vpTreeData), _index(index), _lpDistance(lpDistance), _dimension(vpTreeData.getDimension()) {}
     bool operator()(const int& a, const int& b) {
-        vector<float>& aNumberVector = _vpTreeData.getNumberVector(a);
-        vector<float>& bNumberVector = _vpTreeData.getNumberVector(b);
-        vector<float>& cNumberVector = _vpTreeData.getNumberVector(_index);
-        if(_lpDistance(aNumberVector, cNumberVector) < _lpDistance(bNumberVector, cNumberVector)) {
+        const float* aNumberVector = _vpTreeData.getNumberVector(a);
+        const float* bNumberVector = _vpTreeData.getNumberVector(b);
+        const float* cNumberVector = _vpTreeData.getNumberVector(_index);
+        if(_lpDistance(aNumberVector, cNumberVector, _dimension) < _lpDistance(bNumberVector, cNumberVector, _dimension)) {
             return true;
         } else {
             return false;
@@ -188,6 +215,7 @@ struct VpDistance {
     VpTreeData& _vpTreeData;
     int _index;
     LpDistance& _lpDistance;
+    int _dimension;
 };
 
 class VpElement {
@@ -224,12 +252,12 @@ public:
         return getDistance() < vpElement.getDistance();
     }
 
-    void write(ofstream& os) {
+    void write(OutStream& os) {
         InOut::Write(os, _index);
         InOut::Write(os, _distance);
         InOut::Write(os, _category);
     }
-    void read(ifstream& is) {
+    void read(InStream& is) {
         InOut::Read(is, _index);
         InOut::Read(is, _distance);
         InOut::Read(is, _category);
@@ -296,10 +324,19 @@ private:
 };
 
 class VpTree {
+    // State of a single search
+    struct SearchState {
+        SearchState(int d): tau(numeric_limits<float>::max()), dimension(d) {
+        }
+        float tau;
+        set<float> unique;
+        int dimension;
+    };
+
 public:
-    VpTree(): _pVpNode(0), _pVpTreeData(0), _tau(numeric_limits<float>::max()), _pProgress(0), _pLpDistance(0) {
+    VpTree(): _pVpNode(0), _pVpTreeData(0), _pProgress(0), _pLpDistance(0) {
     }
-    VpTree(VpTreeData* pVpTreeData, LpDistance* pLpDistance, Progress* pProgress): _pVpNode(0), _pVpTreeData(pVpTreeData), _tau(numeric_limits<float>::max()), _pProgress(pProgress), _pLpDistance(pLpDistance) {
+    VpTree(VpTreeData* pVpTreeData, LpDistance* pLpDistance, Progress* pProgress): _pVpNode(0), _pVpTreeData(pVpTreeData), _pProgress(pProgress), _pLpDistance(pLpDistance) {
     }
     ~VpTree() {
         delete _pVpNode;
@@ -362,7 +399,7 @@ public:
         }
     }
 
-    vector<VpElement> kNearestNeighbors(int k, vector<VpElement>& nearestNeighbors) {
+    vector<VpElement> kNearestNeighbors(int k, vector<VpElement>& nearestNeighbors) const {
         VpElementCompare vpElementCompare;
         sort(nearestNeighbors.begin(), nearestNeighbors.end(), vpElementCompare);
 
@@ -372,11 +409,18 @@ public:
 
         return nearestNeighbors;
     }
-    void search(const vector<float>& target, int k, vector<VpElement>& nearestNeighbors) {
+    void search(const vector<float>& target, int k, vector<VpElement>& nearestNeighbors) const {
+        if((int)target.size() != _pVpTreeData->getDimension()) {
+            throw string(cDifferentSizes);
+        }
+        search(target.data(), k, nearestNeighbors);
+    }
+    // Search the k nearest neighbors of a target of getDimension() values.
+    // The search state is local, so searches may run concurrently.
+    void search(const float* target, int k, vector<VpElement>& nearestNeighbors) const {
         priority_queue<VpElement> priorityQueue;
-        _tau = numeric_limits<float>::max();
-        _unique.clear();
-        search(_pVpNode, target, k, priorityQueue);
+        SearchState searchState(_pVpTreeData->getDimension());
+        search(_pVpNode, target, k, priorityQueue, searchState);
 
         nearestNeighbors.clear();
         while(!priorityQueue.empty()) {
@@ -388,59 +432,65 @@ public:
         nearestNeighbors = kNearestNeighbors(k, nearestNeighbors);
     }
 
-    void search(VpNode* pVpNode, const vector<float>& target, int k, priority_queue<VpElement>& priorityQueue) {
+    void search(VpNode* pVpNode, const float* target, int k, priority_queue<VpElement>& priorityQueue, SearchState& searchState) const {
         if(pVpNode == 0) {
             return;
         }
 
-        vector<float>& numberVector = _pVpTreeData->getNumberVector(_indexVector[pVpNode->getIndex()]);
-        float d = (*_pLpDistance)(numberVector, target);
-        if(d <= _tau) {
-            _unique.insert(d);
-            if((int)_unique.size() > k || (int)priorityQueue.size() > cMaxNearestNeighbors) {
+        const float* numberVector = _pVpTreeData->getNumberVector(_indexVector[pVpNode->getIndex()]);
+        float d = (*_pLpDistance)(numberVector, target, searchState.dimension);
+        if(d <= searchState.tau) {
+            searchState.unique.insert(d);
+            if((int)searchState.unique.size() > k || (int)priorityQueue.size() > cMaxNearestNeighbors) {
                 float tau = priorityQueue.top().getDistance();
                 while(!priorityQueue.empty() && priorityQueue.top().getDistance() == tau) {
                     priorityQueue.pop();
                 }
-                _unique.erase(tau);
+                searchState.unique.erase(tau);
                 priorityQueue.push(VpElement(_indexVector[pVpNode->getIndex()], d));
-                _tau = priorityQueue.top().getDistance();
+                searchState.tau = priorityQueue.top().getDistance();
             } else {
                 priorityQueue.push(VpElement(_indexVector[pVpNode->getIndex()], d));
             }
         }
 
         if(d < pVpNode->getThreshold()) {
-            search(pVpNode->getInVpNode(), target, k, priorityQueue);
-            if(d + _tau >= pVpNode->getThreshold()) {
-                search(pVpNode->getOutVpNode(), target, k, priorityQueue);
+            search(pVpNode->getInVpNode(), target, k, priorityQueue, searchState);
+            if(d + searchState.tau >= pVpNode->getThreshold()) {
+                search(pVpNode->getOutVpNode(), target, k, priorityQueue, searchState);
             }
         } else if(d == pVpNode->getThreshold()) {
-            search(pVpNode->getInVpNode(), target, k, priorityQueue);
-            search(pVpNode->getOutVpNode(), target, k, priorityQueue);
+            search(pVpNode->getInVpNode(), target, k, priorityQueue, searchState);
+            search(pVpNode->getOutVpNode(), target, k, priorityQueue, searchState);
         } else if(d > pVpNode->getThreshold()) {
-            search(pVpNode->getOutVpNode(), target, k, priorityQueue);
-            if(d - _tau <= pVpNode->getThreshold()) {
-                search(pVpNode->getInVpNode(), target, k, priorityQueue);
+            search(pVpNode->getOutVpNode(), target, k, priorityQueue, searchState);
+            if(d - searchState.tau <= pVpNode->getThreshold()) {
+                search(pVpNode->getInVpNode(), target, k, priorityQueue, searchState);
             }
         }
     }
-    void linearSearch(const vector<float>& target, int k, vector<VpElement>& nearestNeighbors) {
+    void linearSearch(const vector<float>& target, int k, vector<VpElement>& nearestNeighbors) const {
+        if((int)target.size() != _pVpTreeData->getDimension()) {
+            throw string(cDifferentSizes);
+        }
+        linearSearch(target.data(), k, nearestNeighbors);
+    }
+    void linearSearch(const float* target, int k, vector<VpElement>& nearestNeighbors) const {
         priority_queue<VpElement> priorityQueue;
-        _unique.clear();
+        SearchState searchState(_pVpTreeData->getDimension());
         for(int i = 0; (int)i < _pVpTreeData->getSize(); i++) {
-            vector<float> numberVector = _pVpTreeData->getNumberVector(i);
-            float d = (*_pLpDistance)(numberVector, target);
-            if(d <= _tau) {
-                _unique.insert(d);
-                if((int)_unique.size() > k) {
+            const float* numberVector = _pVpTreeData->getNumberVector(i);
+            float d = (*_pLpDistance)(numberVector, target, searchState.dimension);
+            if(d <= searchState.tau) {
+                searchState.unique.insert(d);
+                if((int)searchState.unique.size() > k) {
                     float tau = priorityQueue.top().getDistance();
                     while(!priorityQueue.empty() && priorityQueue.top().getDistance() == tau) {
                         priorityQueue.pop();
                     }
-                    _unique.erase(tau);
+                    searchState.unique.erase(tau);
                     priorityQueue.push(VpElement(i, d));
-                    _tau = priorityQueue.top().getDistance();
+                    searchState.tau = priorityQueue.top().getDistance();
 
                 } else {
                     priorityQueue.push(VpElement(i, d));
@@ -457,6 +507,27 @@ public:
         nearestNeighbors = kNearestNeighbors(k, nearestNeighbors);
     }
 
+    // Maximum of radii over the rows of the subtree of each node, indexed
+    // like the nodes. Rows with negative radius are never found.
+    void getSubtreeRadii(const vector<float>& radii, vector<float>& subtreeRadii) const {
+        subtreeRadii.assign(_indexVector.size(), -1);
+        getSubtreeRadii(_pVpNode, radii, subtreeRadii);
+    }
+    // Reverse range search: indices of all rows i whose distance to the
+    // target is at most radii[i]. Subtrees are pruned with the triangle
+    // inequality against the maximum radius of their rows.
+    void reverseRangeSearch(const float* target, const vector<float>& radii, const vector<float>& subtreeRadii, vector<int>& indices) const {
+        indices.clear();
+        reverseRangeSearch(_pVpNode, target, radii, subtreeRadii, _pVpTreeData->getDimension(), indices);
+    }
+    // Range search: indices of all rows whose distance to the target is at
+    // most radius. The search state is local, so searches may run
+    // concurrently.
+    void rangeSearch(const float* target, float radius, vector<int>& indices) const {
+        indices.clear();
+        rangeSearch(_pVpNode, target, radius, _pVpTreeData->getDimension(), indices);
+    }
+
     void test(int begin, int end, int nNearestNeighbors) {
         if(begin >= _pVpTreeData->getSize())
         {
@@ -466,8 +537,10 @@ public:
         {
             end = _pVpTreeData->getSize();
         }
+        int dimension = _pVpTreeData->getDimension();
         for(int i = begin; i < end; i++) {
-            vector<float> numberVector = _pVpTreeData->getNumberVector(i);
+            const float* p = _pVpTreeData->getNumberVector(i);
+            vector<float> numberVector(p, p + dimension);
 
             Function f("message");
             f("numberVector");
@@ -482,7 +555,8 @@ public:
             linearSearch(numberVector, nNearestNeighbors, lNearestNeighbors);
 
             for(int j = 0; j < (int)nearestNeighbors.size(); j++) {
-                numberVector = _pVpTreeData->getNumberVector(nearestNeighbors[j].getIndex());
+                p = _pVpTreeData->getNumberVector(nearestNeighbors[j].getIndex());
+                numberVector.assign(p, p + dimension);
                 f("nnumberVector");
                 for(int k = 0; k < (int)numberVector.size(); k++) {
                     f(numberVector[k]);
@@ -504,14 +578,61 @@ public:
     }
 
 private:
+    float getSubtreeRadii(VpNode* pVpNode, const vector<float>& radii, vector<float>& subtreeRadii) const {
+        if(pVpNode == 0) {
+            return -1;
+        }
+        float radius = radii[_indexVector[pVpNode->getIndex()]];
+        radius = max(radius, getSubtreeRadii(pVpNode->getInVpNode(), radii, subtreeRadii));
+        radius = max(radius, getSubtreeRadii(pVpNode->getOutVpNode(), radii, subtreeRadii));
+        subtreeRadii[pVpNode->getIndex()] = radius;
+        return radius;
+    }
+    void reverseRangeSearch(VpNode* pVpNode, const float* target, const vector<float>& radii, const vector<float>& subtreeRadii, int dimension, vector<int>& indices) const {
+        if(pVpNode == 0 || subtreeRadii[pVpNode->getIndex()] < 0) {
+            return;
+        }
+
+        int index = _indexVector[pVpNode->getIndex()];
+        float d = (*_pLpDistance)(_pVpTreeData->getNumberVector(index), target, dimension);
+        if(d <= radii[index]) {
+            indices.push_back(index);
+        }
+
+        VpNode* pInVpNode = pVpNode->getInVpNode();
+        if(pInVpNode != 0 && d - pVpNode->getThreshold() <= subtreeRadii[pInVpNode->getIndex()]) {
+            reverseRangeSearch(pInVpNode, target, radii, subtreeRadii, dimension, indices);
+        }
+        VpNode* pOutVpNode = pVpNode->getOutVpNode();
+        if(pOutVpNode != 0 && pVpNode->getThreshold() - d <= subtreeRadii[pOutVpNode->getIndex()]) {
+            reverseRangeSearch(pOutVpNode, target, radii, subtreeRadii, dimension, indices);
+        }
+    }
+    void rangeSearch(VpNode* pVpNode, const float* target, float radius, int dimension, vector<int>& indices) const {
+        if(pVpNode == 0) {
+            return;
+        }
+
+        int index = _indexVector[pVpNode->getIndex()];
+        float d = (*_pLpDistance)(_pVpTreeData->getNumberVector(index), target, dimension);
+        if(d <= radius) {
+            indices.push_back(index);
+        }
+
+        if(d - radius <= pVpNode->getThreshold()) {
+            rangeSearch(pVpNode->getInVpNode(), target, radius, dimension, indices);
+        }
+        if(d + radius >= pVpNode->getThreshold()) {
+            rangeSearch(pVpNode->getOutVpNode(), target, radius, dimension, indices);
+        }
+    }
+
     vector<int> _indexVector;
     VpNode* _pVpNode;
     VpTreeData* _pVpTreeData;
-    float _tau;
     Progress* _pProgress;
     LpDistance* _pLpDistance;
 
-    set<float> _unique;
     int _i;
 
     UniformIntDistribution _uniformIntDistribution;